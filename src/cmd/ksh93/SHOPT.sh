@@ -14,6 +14,7 @@ SHOPT BGX=1				# one SIGCHLD trap per completed job
 SHOPT BRACEPAT=1			# C-shell {...,...} expansions (, required)
 SHOPT CMDLIB_HDR=  # '<cmdlist.h>'	# custom -lcmd list for path-bound builtins
 SHOPT CMDLIB_DIR=  # '"/opt/ast/bin"'	# virtual directory prefix for path-bound builtins
+SHOPT COMSUBMEM=1048576			# bytes of command substitution output kept in memory before using a temp file
 SHOPT CRNL=				# accept MS Windows newlines (<cr><nl>) for <nl>
 SHOPT DEVFD=				# use /dev/fd instead of FIFOs for process substitutions
 SHOPT DYNAMIC=1				# dynamic loading for builtins
@@ -29,6 +30,7 @@ SHOPT MULTIBYTE=			# multibyte character handling
 SHOPT NAMESPACE=1			# allow namespaces
 SHOPT NOECHOE=0				# turn off 'echo -e' when SHOPT_ECHOPRINT is disabled
 SHOPT OPTIMIZE=1			# optimize loop invariants
+SHOPT PATHCACHE=1			# cache the file names in $PATH directories for command search
 SHOPT P_SUID=0				# real UIDs >= this value require -p for set[ug]id (to turn off, use empty, not 0)
 SHOPT PRINTF_LEGACY=			# allow noncompliant printf(1) syntax (format arg starting with '-' without prior '--')
 SHOPT REGRESS=				# enable __regress__ builtin and instrumented intercepts for testing
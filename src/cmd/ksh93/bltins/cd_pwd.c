@@ -123,7 +123,10 @@ int	b_cd(int argc, char *argv[],Shbltin_t *context)
 #if _lib_fchdir
 		if(!test_inode(sh.pwd,e_dot))
 #endif
+		{
+			sh_stats(STAT_SFCD);
 			sh_subfork();
+		}
 	}
 	/*
 	 * Do $CDPATH processing, except if the path is absolute or the first component is '.' or '..'
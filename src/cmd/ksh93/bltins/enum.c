@@ -241,7 +241,10 @@ int b_enum(int argc, char** argv, Shbltin_t *context)
 		return 1;
 	}
 	if(sh.subshell && !sh.subshare)
+	{
+		sh_stats(STAT_SFTYPE);
 		sh_subfork();
+	}
 	while(cp = *argv++)
 	{
 		/* Do not allow 'enum' to override special built-ins -- however, exclude
@@ -96,6 +96,10 @@ int	b_getopts(int argc,char *argv[],Shbltin_t *context)
 	}
 	else
 	{
+#if SHOPT_FILESCAN
+		if(sh_scanpending())
+			sh_scanargs();
+#endif /* SHOPT_FILESCAN */
 		argv = sh.st.dolv;
 		argc = sh.st.dolc;
 	}
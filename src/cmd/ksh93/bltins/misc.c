@@ -122,7 +122,10 @@ int    b_exec(int argc,char *argv[], Shbltin_t *context)
 		Namval_t* np;
 		char *cp;
 		if(arg0 && sh.subshell && !sh.subshare)
+		{
+			sh_stats(STAT_SFEXEC);
 			sh_subfork();
+		}
 		if(clear)
 			nv_scan(sh.var_tree,noexport,0,NV_EXPORT,NV_EXPORT);
 		while(arg)
@@ -144,7 +147,10 @@ int    b_exec(int argc,char *argv[], Shbltin_t *context)
 			return 1;
 		/* if the main shell is about to be replaced, decrease SHLVL to cancel out a subsequent increase */
 		if(!sh.realsubshell)
+		{
 			(*SHLVL->nvalue.ip)--;
+			env_change();
+		}
 		sh_onstate(SH_EXEC);
 		if(sh.subshell && !sh.subshare)
 		{
@@ -315,12 +321,13 @@ int    b_dot_cmd(int n,char *argv[],Shbltin_t *context)
 	{
 		sh.dot_depth++;
 		update_sh_level();
+		sh_profcall(np ? nv_name(np) : sh.st.filename);
 		if(np)
 			sh_exec((Shnode_t*)(nv_funtree(np)),sh_isstate(SH_ERREXIT));
 		else
 		{
 			buffer = sh_malloc(IOBSIZE+1);
-			iop = sfnew(NULL,buffer,IOBSIZE,fd,SFIO_READ);
+			iop = path_cacheopen(fd,buffer);
 			sh_offstate(SH_NOFORK);
 			sh_eval(iop,sh_isstate(SH_PROFILE)?SH_FUNEVAL:0);
 		}
@@ -392,6 +399,10 @@ int    b_shift(int n, char *argv[], Shbltin_t *context)
 	}
 	argv += opt_info.index;
 	n = ((arg= *argv)?(int)sh_arith(arg):1);
+#if SHOPT_FILESCAN
+	if(sh_scanpending())
+		sh_scanargs();
+#endif /* SHOPT_FILESCAN */
 	if(n < 0 || sh.st.dolc < n)
 	{
 		errormsg(SH_DICT,ERROR_exit(1),e_number,arg);
@@ -407,9 +418,13 @@ int    b_shift(int n, char *argv[], Shbltin_t *context)
 
 int    b_wait(int n,char *argv[],Shbltin_t *context)
 {
+	int next = 0;
 	NOT_USED(context);
 	while((n = optget(argv,sh_optwait))) switch(n)
 	{
+		case 'n':
+			next = 1;
+			break;
 		case ':':
 			errormsg(SH_DICT,2, "%s", opt_info.arg);
 			break;
@@ -423,7 +438,7 @@ int    b_wait(int n,char *argv[],Shbltin_t *context)
 		UNREACHABLE();
 	}
 	argv += opt_info.index;
-	job_bwait(argv);
+	job_bwait(argv,next);
 	return sh.exitval;
 }
 
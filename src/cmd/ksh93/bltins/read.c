@@ -196,6 +196,145 @@ bypass:
 	return r;
 }
 
+/*
+ * mapfile [-t] [-d delim] [-n count] [-O origin] [-s count] [-u fd] [array]
+ * Read records into the elements of an indexed array in one pass
+ */
+int	b_mapfile(int argc,char *argv[], Shbltin_t *context)
+{
+	const char	*name = "MAPFILE";
+	Namval_t	*np;
+	Namarr_t	*ap;
+	Sfio_t		*iop;
+	char		*cp;
+	ssize_t		n;
+	Sflong_t	count=0, skip=0, origin=0;
+	int		r, fd=0, delim='\n', strip=0, clear=1, jmpval=0, was_share;
+	struct checkpt	buff;
+	NOT_USED(argc);
+	NOT_USED(context);
+	while((r = optget(argv,sh_optmapfile))) switch(r)
+	{
+	    case 'd':
+		delim = *(unsigned char*)opt_info.arg;
+		break;
+	    case 'n':
+		count = opt_info.num;
+		break;
+	    case 'O':
+		origin = opt_info.num;
+		clear = 0;
+		break;
+	    case 's':
+		skip = opt_info.num;
+		break;
+	    case 't':
+		strip = 1;
+		break;
+	    case 'u':
+		fd = (int)strtol(opt_info.arg,&opt_info.arg,10);
+		if(*opt_info.arg || !sh_iovalidfd(fd) || sh_inuse(fd))
+			fd = -1;
+		break;
+	    case ':':
+		errormsg(SH_DICT,2, "%s", opt_info.arg);
+		break;
+	    case '?':
+		errormsg(SH_DICT,ERROR_usage(2), "%s", opt_info.arg);
+		UNREACHABLE();
+	}
+	argv += opt_info.index;
+	if(error_info.errors || *argv && argv[1] || count<0 || skip<0 || origin<0 || origin>=ARRAY_MAX)
+	{
+		errormsg(SH_DICT,ERROR_usage(2), "%s", optusage(NULL));
+		UNREACHABLE();
+	}
+	if(*argv)
+		name = *argv;
+	if(fd<0 || !((r=sh.fdstatus[fd])&IOREAD) && !((r=sh_iocheckfd(fd))&IOREAD))
+	{
+		errormsg(SH_DICT,ERROR_system(1),e_file+4);
+		UNREACHABLE();
+	}
+	if(strchr(name,'['))
+	{
+		errormsg(SH_DICT,ERROR_exit(1),e_varname,name);
+		UNREACHABLE();
+	}
+	np = nv_open(name,sh.var_tree,NV_VARNAME);
+	if(nv_isattr(np,NV_RDONLY))
+	{
+		errormsg(SH_DICT,ERROR_exit(1),e_readonly,nv_name(np));
+		UNREACHABLE();
+	}
+	if((ap = nv_arrayptr(np)) && array_assoc(ap))
+	{
+		errormsg(SH_DICT,ERROR_exit(1),"%s: not an indexed array",nv_name(np));
+		UNREACHABLE();
+	}
+	if(clear)
+	{
+		/* keep the array and its attributes, as 'read -A' does */
+		if(ap)
+			ap->nelem++;
+		nv_unset(np);
+		if(ap = nv_arrayptr(np))
+			ap->nelem--;
+		else if(nv_isnull(np))
+			nv_onattr(np,NV_ARRAY);
+	}
+	if(!(iop=sh.sftable[fd]) && !(iop=sh_iostream(fd)))
+	{
+		nv_close(np);
+		return 1;
+	}
+	sh_stats(STAT_READS);
+	sfclrerr(iop);
+	/* when reading all input, nothing needs to be left unread for the next command */
+	if(!count)
+		was_share = (sfset(iop,SFIO_SHARE,0)&SFIO_SHARE)!=0;
+	else if(fd==0)
+		was_share = (sfset(iop,SFIO_SHARE,sh.redir0!=2)&SFIO_SHARE)!=0;
+	else
+		was_share = (sfset(iop,0,0)&SFIO_SHARE)!=0;
+	if(sh.fdstatus[fd]&(IOTTY|IONOSEEK))
+	{
+		sh_pushcontext(&buff,1);
+		jmpval = sigsetjmp(buff.buff,0);
+		if(jmpval)
+			goto done;
+	}
+	/*
+	 * sfgetr() finds each delimiter in the stream's buffer, refilling it
+	 * with large reads, or (on a shared pipe) reads no further than the
+	 * delimiter, so that input after a -n count remains for the next command.
+	 */
+	while((cp = sfgetr(iop,delim,0)) || (cp = sfgetr(iop,delim,SFIO_LASTR)))
+	{
+		n = sfvalue(iop);
+		if(skip)
+		{
+			skip--;
+			continue;
+		}
+		if(strip && n && cp[n-1]==delim)
+			n--;
+		sfwrite(sh.strbuf,cp,n);
+		nv_putsub(np,NULL,origin|ARRAY_ADD|ARRAY_FILL);
+		nv_putval(np,sfstruse(sh.strbuf),0);
+		if(++origin >= ARRAY_MAX || count && --count==0)
+			break;
+	}
+done:
+	if(sh.fdstatus[fd]&(IOTTY|IONOSEEK))
+		sh_popcontext(&buff);
+	sfset(iop,SFIO_SHARE,was_share);
+	nv_close(np);
+	if(jmpval > 1)
+		siglongjmp(*sh.jmplist,jmpval);
+	return jmpval;
+}
+
 /*
  * here for read timeout
  */
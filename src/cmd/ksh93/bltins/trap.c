@@ -160,7 +160,10 @@ int	b_trap(int argc,char *argv[],Shbltin_t *context)
 				 * may cause a virtual subshell to fork) to ensure a persistent PID.
 				 */
 				if(sh.subshell && !sh.subshare)
+				{
+					sh_stats(STAT_SFSIGNAL);
 					sh_subfork();
+				}
 				if(sig >= sh.st.trapmax)
 					sh.st.trapmax = sig+1;
 				arg = sh.st.trapcom[sig];
@@ -275,6 +275,9 @@ int    b_typeset(int argc,char *argv[],Shbltin_t *context)
 			case 'A':
 				flag |= NV_ARRAY;
 				break;
+			case 'O':
+				flag |= NV_ARRAY|NV_AORDER;
+				break;
 			case 'C':
 				flag |= NV_COMVAR;
 				break;
@@ -646,9 +649,10 @@ static int     setall(char **argv,int flag,Dt_t *troot,struct tdata *tp)
 	char *name;
 	char *last = 0;
 	int nvflags=(flag&(NV_ARRAY|NV_NOARRAY|NV_VARNAME|NV_IDENT|NV_ASSIGN|NV_STATIC|NV_MOVE));
-	int r=0, ref=0, comvar=(flag&NV_COMVAR),iarray=(flag&NV_IARRAY);
+	int r=0, ref=0, comvar=(flag&NV_COMVAR),iarray=(flag&NV_IARRAY),aorder=(flag&NV_AORDER);
 	Dt_t *save_vartree = NULL;
 	Namval_t *save_namespace = NULL;
+	flag &= ~NV_AORDER;
 	if(flag&NV_GLOBAL)
 	{
 		save_vartree = sh.var_tree;
@@ -739,7 +743,10 @@ static int     setall(char **argv,int flag,Dt_t *troot,struct tdata *tp)
 						continue;
 					}
 					if(sh.subshell && !sh.subshare)
+					{
+						sh_stats(STAT_SFTYPESET);
 						sh_subfork();
+					}
 					if(tp->aflag=='-')
 						nv_onattr(np,flag|NV_FUNCTION);
 					else if(tp->aflag=='+')
@@ -769,8 +776,15 @@ static int     setall(char **argv,int flag,Dt_t *troot,struct tdata *tp)
 				path_settrackedalias(name,path_absolute(name,NULL,0));
 				continue;
 			}
-			if(troot==sh.alias_tree && sh.subshell && !sh.subshare && strchr(name,'='))
-				sh_subfork();	/* avoid affecting the parent shell's alias table */
+			if(troot==sh.alias_tree && strchr(name,'='))
+			{
+				if(sh.subshell && !sh.subshare)
+				{
+					sh_stats(STAT_SFALIAS);
+					sh_subfork();	/* avoid affecting the parent shell's alias table */
+				}
+				sh_parseflush();	/* cached parse trees may have used the old alias */
+			}
 			np = nv_open(name,troot,nvflags|((nvflags&NV_ASSIGN)?0:NV_ARRAY)|((iarray|(nvflags&(NV_REF|NV_NOADD)==NV_REF))?NV_FARRAY:0));
 			if(!np || (troot==sh.track_tree && nv_isattr(np,NV_NOALIAS)))
 			{
@@ -835,7 +849,10 @@ static int     setall(char **argv,int flag,Dt_t *troot,struct tdata *tp)
 					 * (LC_*, LINENO, etc.) need to be cloned, as moving them will remove the discipline.
 					 */
 					if((flag&NV_ARRAY) && !sh.envlist && !nv_isnull(np))
+					{
+						sh_stats(STAT_SFTYPESET);
 						sh_subfork();	/* work around https://github.com/ksh93/ksh/issues/409 */
+					}
 					else
 						sh_assignok(np, !nv_isattr(np,NV_NODISC|NV_ARRAY) && !nv_isvtree(np));
 				}
@@ -866,6 +883,8 @@ static int     setall(char **argv,int flag,Dt_t *troot,struct tdata *tp)
 						}
 					}
 					nv_setarray(np,nv_associative);
+					if(aorder)
+						nv_aorder(np);
 				}
 				else if(comvar && !nv_isvtree(np) && !nv_rename(np,flag|NV_COMVAR))
 					nv_setvtree(np);
@@ -1170,7 +1189,10 @@ int	b_builtin(int argc,char *argv[],Shbltin_t *context)
 			UNREACHABLE();
 		}
 		if(sh.subshell && !sh.subshare)
+		{
+			sh_stats(STAT_SFTYPE);
 			sh_subfork();
+		}
 	}
 #if SHOPT_DYNAMIC
 	if(arg)
@@ -1330,6 +1352,8 @@ static int unall(int argc, char **argv, Dt_t *troot)
 	if(!troot)
 		return 1;
 	r = 0;
+	if(troot==sh.alias_tree)
+		sh_parseflush();	/* cached parse trees may have used these aliases */
 	if(troot==sh.var_tree)
 		nflag |= NV_VARNAME;
 	else
@@ -1339,7 +1363,10 @@ static int unall(int argc, char **argv, Dt_t *troot)
 		if(dtfirst(troot))
 		{
 			if(troot==sh.alias_tree && sh.subshell && !sh.subshare)
+			{
+				sh_stats(STAT_SFALIAS);
 				sh_subfork();	/* avoid affecting the parent shell's alias table */
+			}
 			dtclear(troot);
 		}
 		return r;
@@ -1423,7 +1450,10 @@ static int unall(int argc, char **argv, Dt_t *troot)
 			else if(troot==sh.alias_tree)
 			{
 				if(sh.subshell && !sh.subshare)
+				{
+					sh_stats(STAT_SFALIAS);
 					sh_subfork();	/* avoid affecting the parent shell's alias table */
+				}
 				_nv_unset(np,nv_isattr(np,NV_NOFREE));
 				nv_delete(np,troot,0);
 			}
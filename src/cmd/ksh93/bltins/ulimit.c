@@ -133,8 +133,21 @@ int	b_ulimit(int argc,char *argv[],Shbltin_t *context)
 		unit = shtab_units[tp->type];
 		if(limit)
 		{
+			/*
+			 * A virtual subshell saves a soft limit to restore on exit, but a lowered hard limit
+			 * cannot be raised again, so setting the hard limit (the default) forks the subshell.
+			 * So do soft limits that count what the shell process has used since it started, like
+			 * CPU time, or that it may need itself, like memory: these would kill the main shell.
+			 */
+#if _lib_getrlimit
+			if(sh.subshell && !sh.subshare && ((mode&HARD) || n!=RLIMIT_CORE && n!=RLIMIT_NOFILE && n!=RLIMIT_NPROC))
+#else
 			if(sh.subshell && !sh.subshare)
+#endif /* _lib_getrlimit */
+			{
+				sh_stats(STAT_SFULIMIT);
 				sh_subfork();
+			}
 			if(strcmp(limit,e_unlimited)==0)
 				i = INFINITY;
 			else
@@ -166,6 +179,8 @@ int	b_ulimit(int argc,char *argv[],Shbltin_t *context)
 					errormsg(SH_DICT,ERROR_system(1),e_number,limit);
 					UNREACHABLE();
 				}
+				if(sh.subshell && !sh.subshare)
+					sh_sublimit(n,&rlp);
 				if(mode&HARD)
 					rlp.rlim_max = i;
 				if(mode&SOFT)
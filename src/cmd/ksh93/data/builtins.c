@@ -115,6 +115,8 @@ const struct shtable3 shtab_builtins[] =
 	"printf",	NV_BLTIN|BLT_ENV,		bltin(printf),
 	"pwd",		NV_BLTIN|BLT_ENV,		bltin(pwd),
 	"read",		NV_BLTIN|BLT_ENV,		bltin(read),
+	"mapfile",	NV_BLTIN|BLT_ENV,		bltin(mapfile),
+	"readarray",	NV_BLTIN|BLT_ENV,		bltin(mapfile),
 	"sleep",	NV_BLTIN,			bltin(sleep),
 	"alarm",	NV_BLTIN|BLT_ENV,		bltin(alarm),
 	"times",	NV_BLTIN|BLT_ENV|BLT_SPC,	bltin(times),
@@ -1511,6 +1513,37 @@ const char sh_optread[] =
 "[+SEE ALSO?\bprint\b(1), \bprintf\b(1), \bcat\b(1)]"
 ;
 
+const char sh_optmapfile[] =
+"[-1c?\n@(#)$Id: mapfile (ksh 93u+m) 2026-10-18 $\n]"
+"[--catalog?" SH_DICT "]"
+"[+NAME?mapfile, readarray - read lines from standard input into an indexed array]"
+"[+DESCRIPTION?\bmapfile\b reads lines from standard input and assigns "
+	"each line, including its terminating newline, to an element of the "
+	"indexed array \aarray\a, starting at index 0. If \aarray\a is not "
+	"given, \bMAPFILE\b is used. Unless \b-O\b is given, \aarray\a is "
+	"unset first. No field splitting or backslash processing is done. "
+	"The input is read in large blocks if it is a regular file, so this is "
+	"much faster than a \bread\b loop.]"
+"[+?\breadarray\b is an alias for \bmapfile\b.]"
+"[d]:[delim?Read lines terminated by the first character of \adelim\a "
+	"instead of newline. If \adelim\a is empty, lines are terminated by "
+	"a null byte.]"
+"[n]#[count?Read at most \acount\a lines. If \acount\a is 0, all lines are read.]"
+"[O]#[origin?Assign the first line to index \aorigin\a and do not unset "
+	"\aarray\a first.]"
+"[s]#[count?Discard the first \acount\a lines read.]"
+"[t?Remove the terminating delimiter from each line.]"
+"[u]:[fd:=0?Read from file descriptor number \afd\a instead of standard input.]"
+"\n"
+"\n[array]\n"
+"\n"
+"[+EXIT STATUS?]{"
+	"[+0?Successful completion.]"
+	"[+>0?An error occurred.]"
+"}"
+"[+SEE ALSO?\bread\b(1)]"
+;
+
 const char sh_optreadonly[] =
 "[-1c?\n@(#)$Id: readonly (ksh 93u+m) 2020-06-28 $\n]"
 "[--catalog?" SH_DICT "]"
@@ -1929,6 +1962,9 @@ const char sh_opttypeset[] =
 "[A?Associative array. Each \aname\a is converted to an associative "
 	"array. If a variable already exists, the current value will "
 	"become index \b0\b.]"
+"[O?Ordered associative array. Like \b-A\b, but the subscripts of "
+	"each \aname\a are listed in the order in which they were added "
+	"instead of in sorted order.]"
 "[C?Compound variable. Each \aname\a will be a compound variable. If "
 	"\avalue\a names a compound variable it will be copied to \aname\a. "
 	"Otherwise the variable is assigned the empty compound value.]"
@@ -2102,7 +2138,7 @@ const char sh_optunalias[] =
 ;
 
 const char sh_optwait[]	=
-"[-1c?\n@(#)$Id: wait (AT&T Research) 1999-06-17 $\n]"
+"[-1c?\n@(#)$Id: wait (ksh 93u+m) 2026-10-18 $\n]"
 "[--catalog?" SH_DICT "]"
 "[+NAME?wait - wait for process or job completion]"
 "[+DESCRIPTION?\bwait\b with no operands, waits until all jobs "
@@ -2113,12 +2149,19 @@ _JOB_
 "[+?If one or more \ajob\a operands is a process ID or process group ID "
 	"not known by the current shell environment, \bwait\b treats each "
 	"of them as if it were a process that exited with status 127.]"
+"[n?Wait until the next of the \ajob\as, or of all jobs known to the "
+	"current shell environment if no \ajob\a is given, terminates and "
+	"return its exit status. A job that has already terminated but has "
+	"not yet been waited for is returned first. The job is then removed "
+	"from the list of known jobs. If there is no such job, the exit "
+	"status is 127.]"
 "\n"
 "\n[job ...]\n"
 "\n"
 "[+EXIT STATUS?If \await\a is invoked with one or more \ajob\as, and all of "
 	"them have terminated or were not known by the invoking shell, "
 	"the exit status of \bwait\b will be that of the last \ajob\a. "
+	"With \b-n\b, it is that of the job that terminated. "
 	"Otherwise, it will be one of the following:]{"
 	"[+0?\bwait\b utility was invoked with no operands and all "
 		"processes known by the invoking process have terminated.]"
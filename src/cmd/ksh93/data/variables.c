@@ -101,6 +101,7 @@ const struct shtable2 shtab_variables[] =
 	".sh.pid",	NV_PID|NV_NOFREE,		NULL,
 	".sh.ppid",	NV_PID|NV_NOFREE,		NULL,
 	".sh.tilde",	0,				NULL,
+	".sh.profile",	0,				NULL,
 	"SHLVL",	NV_INTEGER|NV_NOFREE|NV_EXPORT,	NULL,
 	"SRANDOM",	NV_NOFREE|NV_INTEGER|NV_UNSIGN,	NULL,
 	"",	0,					NULL
@@ -124,7 +125,20 @@ const Shtable_t shtab_stats[] =
 	"posixfuncall",		STAT_SVFUNCT,
 	"simplecmds",		STAT_SCMDS,
 	"spawns",		STAT_SPAWN,
-	"subshell",		STAT_SUBSHELL
+	"subshell",		STAT_SUBSHELL,
+	"parse_cachehits",	STAT_PARSEHITS,
+	"parse_cachemiss",	STAT_PARSEMISS,
+	"subforks",		STAT_SUBFORKS,
+	"subfork_alias",	STAT_SFALIAS,
+	"subfork_cd",		STAT_SFCD,
+	"subfork_exec",		STAT_SFEXEC,
+	"subfork_redir",	STAT_SFREDIR,
+	"subfork_signal",	STAT_SFSIGNAL,
+	"subfork_subshare",	STAT_SFSUBSHARE,
+	"subfork_type",		STAT_SFTYPE,
+	"subfork_typeset",	STAT_SFTYPESET,
+	"subfork_ulimit",	STAT_SFULIMIT,
+	"scopescans",		STAT_SCOPESCAN
 };
 #endif /* SHOPT_STATS */
 
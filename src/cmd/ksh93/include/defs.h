@@ -129,6 +129,7 @@ extern void 		*sh_macopen(void);
 extern char 		*sh_macpat(struct argnod*,int);
 extern Sfdouble_t	sh_mathfun(void*, int, Sfdouble_t*);
 extern int		sh_outtype(Sfio_t*);
+extern void		sh_parseflush(void);
 extern char 		*sh_mactry(char*);
 extern int		sh_mathstd(const char*);
 extern void		sh_printopts(Shopt_t,int,Shopt_t*);
@@ -142,6 +143,7 @@ extern Dt_t		*sh_subfuntree(int);
 extern void		sh_subjobcheck(pid_t);
 extern int		sh_subsavefd(int);
 extern void		sh_subtmpfile(void);
+extern int		sh_simplematch(const char*,const char*);
 extern char 		*sh_substitute(const char*,const char*,char*);
 extern void		sh_timetraps(void);
 extern const char	*_sh_translate(const char*);
@@ -152,6 +154,26 @@ extern void             sh_unscope(void);
 #if SHOPT_NAMESPACE
     extern Namval_t	*sh_fsearch(const char *,int);
 #endif /* SHOPT_NAMESPACE */
+#if SHOPT_FILESCAN
+    /*
+     * State of a 'while <file' loop. The fields of each line replace the
+     * positional parameters of the scope the loop runs in; they are only
+     * split when one is first used, which is while sh_scanpending() is true.
+     */
+    struct Filescan
+    {
+	struct Filescan	*prev;		/* enclosing 'while <file' loop */
+	char		**dolv;		/* positional parameters to replace */
+	int		dolc;
+	struct dolnod	*dolh;		/* keeps dolv from being freed and reused */
+	char		*buf;		/* copy of the line, split into fields */
+	size_t		bufsize;
+	char		**argv;		/* $0 and the fields */
+	int		argmax;
+    };
+    extern void		sh_scanargs(void);
+#   define sh_scanpending()	(sh.filescan && sh.st.dolv==sh.filescan->dolv)
+#endif /* SHOPT_FILESCAN */
 
 /* malloc related wrappers */
 extern void		*sh_malloc(size_t size);
@@ -233,10 +255,33 @@ extern const char	e_scriptonly[];
 #   define	STAT_SCMDS	11
 #   define	STAT_SPAWN	12
 #   define	STAT_SUBSHELL	13
+#   define	STAT_PARSEHITS	14
+#   define	STAT_PARSEMISS	15
+#   define	STAT_SUBFORKS	16	/* virtual subshells forked by sh_subfork(), by cause: */
+#   define	STAT_SFALIAS	17
+#   define	STAT_SFCD	18
+#   define	STAT_SFEXEC	19
+#   define	STAT_SFREDIR	20
+#   define	STAT_SFSIGNAL	21
+#   define	STAT_SFSUBSHARE	22
+#   define	STAT_SFTYPE	23
+#   define	STAT_SFTYPESET	24
+#   define	STAT_SFULIMIT	25
+#   define	STAT_SCOPESCAN	26	/* scans of a calling function's scope for exports */
+#   define	STAT_NUMSTATS	27	/* number of counters */
     extern const Shtable_t shtab_stats[];
 #   define sh_stats(x)	(sh.stats[(x)]++)
+    /* .sh.profile hooks; these cost a single test while not profiling */
+    extern void		sh_profinit(void);
+    extern void		sh_proftick(int);
+    extern void		sh_profenter(const char*);
+    extern void		sh_profdone(void);
+#   define sh_profline(line)	(sh.profile ? sh_proftick(line) : (void)0)
+#   define sh_profcall(name)	(sh.profile ? sh_profenter(name) : (void)0)
 #else
 #   define sh_stats(x)
+#   define sh_profline(line)
+#   define sh_profcall(name)
 #endif /* SHOPT_STATS */
 
 #endif /* !defs_h_defined */
@@ -46,7 +46,9 @@
 struct process
 {
 	struct process *p_nxtjob;	/* next job structure */
+	struct process *p_prvjob;	/* previous job structure */
 	struct process *p_nxtproc;	/* next process in current job */
+	struct process *p_nxthash;	/* next process in process ID hash chain */
 	int		*p_exitval;	/* place to store the exitval */
 	pid_t		p_pid;		/* process ID */
 	pid_t		p_pgrp;		/* process group */
@@ -137,7 +139,7 @@ extern const char	e_no_start[];
  */
 
 extern void	job_clear(void);
-extern void	job_bwait(char**);
+extern void	job_bwait(char**,int);
 extern int	job_walk(Sfio_t*,int(*)(struct process*,int),int,char*[]);
 extern int	job_kill(struct process*,int);
 extern int	job_wait(pid_t);
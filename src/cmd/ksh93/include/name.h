@@ -60,8 +60,8 @@ union Value
 #define ARRAY_MAX 	(1L<<ARRAY_BITS) /* maximum number of elements in an array */
 #define ARRAY_MASK	(ARRAY_MAX-1)	/* For index values */
 
-#define ARRAY_INCR	32	/* number of elements to grow when array 
-				   bound exceeded.  Must be a power of 2 */
+#define ARRAY_INCR	32	/* number of elements in each block of an
+				   indexed array.  Must be a power of 2 */
 #define ARRAY_FILL	(8L<<ARRAY_BITS)	/* used with nv_putsub() */
 #define ARRAY_NOCLONE	(16L<<ARRAY_BITS)	/* do not clone array disc */
 #define ARRAY_NOCHILD   (32L<<ARRAY_BITS)	/* skip compound arrays */
@@ -72,6 +72,7 @@ union Value
 #   define ARRAY_FIXED	ARRAY_NOCLONE		/* For index values */
 #endif /* SHOPT_FIXEDARRAY */
 #define NV_FARRAY	0x10000000		/* fixed-size arrays */
+#define NV_AORDER	0x40000000		/* associative array in insertion order */
 #define NV_ASETSUB	8			/* set subscript */
 
 /* These flags are used as options to array_get() */
@@ -172,12 +173,14 @@ struct Ufunction
 
 #define array_elem(ap)	((ap)->nelem&ARRAY_MASK)
 #define array_assoc(ap)	((ap)->fun)
+#define array_order(ap)	((ap)->table && (ap)->table->meth==Dtpset)
 
 extern int		array_maxindex(Namval_t*);
 extern char 		*nv_endsubscript(Namval_t*, char*, int);
 extern Namfun_t 	*nv_cover(Namval_t*);
 extern Namarr_t 	*nv_arrayptr(Namval_t*);
 extern int		nv_arrayisset(Namval_t*, Namarr_t*);
+extern void		nv_aorder(Namval_t*);
 extern int		nv_arraysettype(Namval_t*, Namval_t*,const char*,int);
 extern int		nv_aimax(Namval_t*);
 extern int		nv_atypeindex(Namval_t*, const char*);
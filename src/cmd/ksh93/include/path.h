@@ -58,12 +58,22 @@ typedef struct pathcomp
 	char		*blib;
 	unsigned short	len;
 	unsigned short	flags;
+#if SHOPT_PATHCACHE
+	void		*dircache;	/* list of file names in directory */
+#endif /* SHOPT_PATHCACHE */
 } Pathcomp_t;
 
 #ifndef ARG_RAW
     struct argnod;
 #endif /* !ARG_RAW */
 
+#if SHOPT_PATHCACHE
+    /* call when the shell or its children may have created or changed files */
+#   define path_dirchange()	(sh.pathgen++)
+#else
+#   define path_dirchange()
+#endif /* SHOPT_PATHCACHE */
+
 /* pathname handling routines */
 extern void		path_newdir(Pathcomp_t*);
 extern Pathcomp_t	*path_dirfind(Pathcomp_t*,const char*,int);
@@ -80,6 +90,9 @@ extern int 		path_expand(const char*, struct argnod**, int);
 extern noreturn void 	path_exec(const char*,char*[],struct argnod*);
 extern pid_t		path_spawn(const char*,char*[],char*[],Pathcomp_t*,int);
 extern int		path_open(const char*,Pathcomp_t*);
+extern Sfio_t		*path_cacheopen(int,char*);
+extern void		path_cachetree(void*,Shnode_t*);
+extern void		path_cacheclose(void*,int);
 extern Pathcomp_t 	*path_get(const char*);
 extern char 		*path_pwd(void);
 extern Pathcomp_t	*path_nextcomp(Pathcomp_t*,const char*,Pathcomp_t*);
@@ -30,6 +30,10 @@
 
 #include	<ast.h>
 #include	<cdt.h>
+#if SHOPT_PATHCACHE && _WINIX
+    /* commands are found as ls.exe, ls.bat, etc., which a list of file names cannot tell */
+#   undef SHOPT_PATHCACHE
+#endif
 #include	<history.h>
 #include	<stk.h>
 #ifdef defs_h_defined
@@ -220,6 +224,7 @@ struct sh_scoped
 	struct Ufunction *real_fun;	/* current 'function name' function */
 	int             repl_index;
 	char            *repl_arg;
+	uint32_t	noexports;	/* ast.env_serial+1 when local scope was last found to have no exports */
 };
 
 struct limits
@@ -355,6 +360,8 @@ struct Shell_s
 	void		*lex_context;
 	void		*arg_context;
 	void		*pathlist;
+	void		*scriptcache;	/* compiled script cache writer for the next sh_eval() */
+	unsigned int	aliasexp;	/* number of aliases expanded by the lexer */
 	void		*cdpathlist;
 	char		cond_expan;	/* set while processing ${var=val}, ${var:=val}, ${var?err}, ${var:?err} */
 	struct sh_scoped global;
@@ -362,7 +369,6 @@ struct Shell_s
 	Shinit_f	userinit;
 	Shbltin_f	bltinfun;
 	Shbltin_t	bltindata;
-	int		offsets[10];
 	Sfio_t		**sftable;
 	unsigned char	*fdstatus;
 	const char	*pwd;
@@ -394,8 +400,15 @@ struct Shell_s
 	void		*optlist;	/* linked list of invariant nodes */
 #endif
 #if SHOPT_FILESCAN
-	char		*cur_line;
+	char		*cur_line;	/* line read by a 'while <file' loop, for $REPLY */
+	struct Filescan	*filescan;	/* innermost 'while <file' loop */
 #endif /* SHOPT_FILESCAN */
+#if SHOPT_PATHCACHE
+	unsigned int	pathgen;	/* incremented when $PATH directories may have changed */
+#endif /* SHOPT_PATHCACHE */
+#if SHOPT_STATS
+	struct Profile	*profile;	/* .sh.profile state; NULL if not profiling */
+#endif /* SHOPT_STATS */
 #if !SHOPT_DEVFD
 	char		*fifo;		/* FIFO name for current process substitution */
 	Dt_t		*fifo_tree;	/* for cleaning up process substitution FIFOs */
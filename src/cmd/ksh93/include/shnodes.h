@@ -212,5 +212,6 @@ extern void			sh_funstaks(struct slnod*,int);
 extern Sfio_t 			*sh_subshell(Shnode_t*, volatile int, int);
 extern int			sh_tdump(Sfio_t*, const Shnode_t*);
 extern Shnode_t			*sh_trestore(Sfio_t*);
+extern Shnode_t			*sh_parsestr(char*,size_t,int);
 
 #endif /* _SHNODES_H */
@@ -73,6 +73,7 @@ struct lval
 	const  void	*ptr;
 	int		nosub;
 	char		*sub;
+	Sflong_t	ival;		/* value for INTVALUE and INTASSIGN */
 	short		flag;
 	short		nargs;
 	short		emode;
@@ -97,6 +98,7 @@ typedef struct _arith_
 	short		staksize;
 	short		emode;
 	short		elen;
+	char		intcode;	/* set if arith_exec() may try integer arithmetic */
 } Arith_t;
 #define ARITH_COMP	04	/* set when compile separate from execute */
 #define ARITH_ASSIGNOP	010	/* set during assignment operators */
@@ -165,6 +167,7 @@ typedef struct _arith_
 #define A_ASSIGNOP	55
 #define A_ENUM		56
 #define A_ASSIGNOP1	57
+#define A_PUSHI		58
 
 
 /* define error messages */
@@ -194,6 +197,8 @@ extern const struct 		mathtab shtab_math[];
 #define ASSIGN	1
 #define VALUE	2
 #define MESSAGE	3
+#define INTVALUE	4	/* like VALUE, but only for a Sflong_t in lval.ival; 0 if not possible */
+#define INTASSIGN	5	/* like ASSIGN, but only for a Sflong_t in lval.ival; 0 if not possible */
 
 extern Sfdouble_t arith_strval(const char*,char**,Sfdouble_t(*)(const char**,struct lval*,int,Sfdouble_t),int);
 extern Arith_t *arith_compile(const char*,char**,Sfdouble_t(*)(const char**,struct lval*,int,Sfdouble_t),int);
@@ -181,4 +181,8 @@ extern const int	shtab_units[];
 extern const char	e_unlimited[];
 extern const char*	e_units[];
 
+#if _lib_getrlimit
+extern void		sh_sublimit(int, struct rlimit*);
+#endif /* _lib_getrlimit */
+
 #endif /* _ULIMIT_H */
@@ -110,7 +110,8 @@ extern void sh_save_rand_seed(struct rand *, int);
 #define SH_PIDNOD	(sh.bltin_nodes+62)
 #define SH_PPIDNOD	(sh.bltin_nodes+63)
 #define SH_TILDENOD	(sh.bltin_nodes+64)
-#define SHLVL		(sh.bltin_nodes+65)
-#define SRANDNOD	(sh.bltin_nodes+66)
+#define SH_PROFILENOD	(sh.bltin_nodes+65)
+#define SHLVL		(sh.bltin_nodes+66)
+#define SRANDNOD	(sh.bltin_nodes+67)
 
 #endif /* SH_VALNOD */
@@ -309,7 +309,13 @@ int sh_argopts(int argc,char *argv[])
 			if(argc>0)
 				strsort(argv,argc,strcoll);
 			else
+			{
+#if SHOPT_FILESCAN
+				if(sh_scanpending())
+					sh_scanargs();
+#endif /* SHOPT_FILESCAN */
 				strsort(sh.st.dolv+1,sh.st.dolc,strcoll);
+			}
 		}
 		if(np)
 			nv_setvec(np,0,argc,argv);
@@ -180,7 +180,7 @@ static Namval_t *scope(Namval_t *np,struct lval *lvalue,int assign)
 			{
 				ap = nv_arrayptr(np);
 				if(ap && !ap->table)
-					ap->table = dtopen(&_Nvdisc,Dtoset);
+					ap->table = dtopen(&_Nvdisc,Dtopset);
 				if(ap && ap->table && (nq=nv_search(nv_getsub(np),ap->table,NV_ADD)))
 					nq->nvmeta = np;
 				if(nq && nv_isnull(nq))
@@ -217,6 +217,26 @@ int	sh_mathstd(const char *name)
 	return sh_mathstdfun(name,strlen(name),NULL)!=0;
 }
 
+/*
+ * Returns true if np is a plain signed 32- or 64-bit integer variable with a value
+ * whose storage can be accessed directly by the INTVALUE and INTASSIGN operations
+ */
+static int intvar(Namval_t *np)
+{
+	if(nv_isattr(np,NV_INTEGER|NV_DOUBLE|NV_SHORT|NV_UNSIGN|NV_BINARY|NV_REF|NV_ARRAY)!=NV_INTEGER)
+		return 0;
+	if(!np->nvalue.lp || np->nvalue.cp==Empty)
+		return 0;
+#if SHOPT_OPTIMIZE
+	if(np->nvfun && (np->nvfun->disc!=&OPTIMIZE_disc || np->nvfun->next))
+		return 0;
+#else
+	if(np->nvfun)
+		return 0;
+#endif /* SHOPT_OPTIMIZE */
+	return 1;
+}
+
 static Sfdouble_t arith(const char **ptr, struct lval *lvalue, int type, Sfdouble_t n)
 {
 	Sfdouble_t r= 0;
@@ -540,6 +560,42 @@ static Sfdouble_t arith(const char **ptr, struct lval *lvalue, int type, Sfdoubl
 		}
 		return r;
 	    }
+	    case INTVALUE:
+	    {
+		Namval_t *np = (Namval_t*)(lvalue->value);
+		char *cp = (char*)np;
+		if(lvalue->flag || (cp>=lvalue->expr && cp<lvalue->expr+lvalue->elen))
+			return 0;
+		if(nv_getoptimize() || sh_isoption(SH_NOEXEC) || (lvalue->ptr && !lvalue->eflag))
+			return 0;
+		if(!(np = scope(np,lvalue,0)) || !intvar(np))
+			return 0;
+		lvalue->ovalue = (char*)np;
+		lvalue->ptr = 0;
+		lvalue->eflag = 0;
+		lvalue->ival = nv_isattr(np,NV_LONG) ? *np->nvalue.llp : *np->nvalue.lp;
+		return 1;
+	    }
+	    case INTASSIGN:
+	    {
+		Namval_t *np = (Namval_t*)(lvalue->value);
+		char *cp = (char*)np;
+		int nosub = lvalue->nosub;
+		Sflong_t l = lvalue->ival;
+		if(nosub>0 || lvalue->flag || (cp>=lvalue->expr && cp<lvalue->expr+lvalue->elen))
+			return 0;
+		if(!(np = scope(np,lvalue,1)) || !intvar(np) || nv_isattr(np,NV_RDONLY))
+		{
+			lvalue->nosub = nosub;
+			return 0;
+		}
+		nv_putval(np,(char*)&l,NV_INT64);
+		lvalue->ptr = 0;
+		lvalue->eflag = 0;
+		lvalue->value = (char*)np;
+		lvalue->ival = nv_isattr(np,NV_LONG) ? l : (int32_t)l;
+		return 1;
+	    }
 	    case MESSAGE:
 		sfsync(NULL);
 		if(lvalue->emode&ARITH_COMP)
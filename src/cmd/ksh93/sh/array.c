@@ -31,21 +31,40 @@
 
 #define NUMSIZE	11
 #define is_associative(ap)	array_assoc((Namarr_t*)(ap))
-#define array_setbit(cp, n, b)	(cp[n] |= (b))
-#define array_clrbit(cp, n, b)	(cp[n] &= ~(b))
-#define array_isbit(cp, n, b)	(cp[n] & (b))
+#define array_chunk(ap, n)	((ap)->chunks[(unsigned)(n)/ARRAY_INCR])
+#define array_has(ap, n)	((n)<(ap)->maxi && array_chunk(ap,n))
+#define array_val(ap, n)	(array_chunk(ap,n)->val[(n)&(ARRAY_INCR-1)])
+#define array_peek(ap, n)	(array_has(ap,n)?array_val(ap,n).cp:NULL)
+#define array_slot(ap, n)	(&array_block(ap,n)->val[(n)&(ARRAY_INCR-1)])
+#define array_clrval(ap, n)	(array_has(ap,n)?(array_val(ap,n).cp=0):0)
+#define array_setbit(ap, n, b)	(array_block(ap,n)->bits[(n)&(ARRAY_INCR-1)] |= (b))
+#define array_clrbit(ap, n, b)	(array_has(ap,n)?(array_chunk(ap,n)->bits[(n)&(ARRAY_INCR-1)] &= ~(b)):0)
+#define array_isbit(ap, n, b)	(array_has(ap,n)?(array_chunk(ap,n)->bits[(n)&(ARRAY_INCR-1)] & (b)):0)
+#define array_ispacked(bp, n)	((bp)->num && (bp)->val[(n)].cp==(bp)->num+(n)*(bp)->size)
 #define NV_CHILD		NV_EXPORT
 #define ARRAY_CHILD		1
 #define ARRAY_NOFREE		2
 
+/*
+ * The elements of an indexed array are kept in blocks of ARRAY_INCR
+ * that are only allocated once one of their elements is used, so a
+ * large subscript costs a pointer for each block below it
+ */
+struct array_chunk
+{
+	union Value	val[ARRAY_INCR];	/* array of value holders */
+	char		*num;	/* packed values of integer or float elements */
+	unsigned char	size;	/* size of each packed value */
+	unsigned char	bits[ARRAY_INCR];	/* bit array for child subscripts */
+};
+
 struct index_array
 {
         Namarr_t        header;
 	void		*xp;	/* if set, subscripts will be converted */
         int		cur;    /* index of current element */
         int		maxi;   /* maximum index for array */
-	unsigned char	*bits;	/* bit array for child subscripts */
-        union Value	val[1]; /* array of value holders */
+	struct array_chunk **chunks;	/* maxi/ARRAY_INCR blocks, 0 if unused */
 };
 
 struct assoc_array
@@ -75,6 +94,108 @@ struct assoc_array
    static void array_fixed_setdata(Namval_t*,Namarr_t*,struct fixed_array*);
 #endif /* SHOPT_FIXEDARRAY */
 
+/*
+ * return the block holding element <n>, allocating it if necessary
+ */
+static struct array_chunk *array_block(struct index_array *ap, int n)
+{
+	struct array_chunk **cpp = &array_chunk(ap,n);
+	if(!*cpp)
+		*cpp = sh_newof(NULL,struct array_chunk,1,0);
+	return *cpp;
+}
+
+static void array_freechunks(struct index_array *ap)
+{
+	struct array_chunk *cp;
+	int n = ap->maxi/ARRAY_INCR;
+	if(!ap->chunks)
+		return;
+	while(--n >= 0)
+	{
+		if(cp = ap->chunks[n])
+		{
+			free(cp->num);
+			free(cp);
+		}
+	}
+	free(ap->chunks);
+	ap->chunks = 0;
+}
+
+/*
+ * give <ap> its own copy of the blocks it shares with the array it was copied from
+ */
+static void array_copychunks(struct index_array *ap)
+{
+	struct array_chunk **old = ap->chunks, *cp;
+	int n = ap->maxi/ARRAY_INCR, i;
+	ap->chunks = sh_newof(NULL,struct array_chunk*,n,0);
+	while(--n >= 0)
+	{
+		if(!old[n])
+			continue;
+		cp = ap->chunks[n] = new_of(struct array_chunk,0);
+		memcpy(cp,old[n],sizeof(struct array_chunk));
+		if(!cp->num)
+			continue;
+		cp->num = sh_malloc(ARRAY_INCR*cp->size);
+		memcpy(cp->num,old[n]->num,ARRAY_INCR*cp->size);
+		for(i=0; i < ARRAY_INCR; i++)
+		{
+			if(array_ispacked(old[n],i))
+				cp->val[i].cp = cp->num+i*cp->size;
+		}
+	}
+}
+
+/*
+ * Give the unset element <up> of integer or float array <np> a value
+ * in the packed storage of its block so that nv_putval() does not
+ * allocate one. Values of other sizes are allocated as usual.
+ */
+static void array_pack(Namval_t *np, struct index_array *ap, union Value *up)
+{
+	struct array_chunk *cp = array_chunk(ap,ap->cur);
+	int n = ap->cur&(ARRAY_INCR-1);
+	size_t size;
+	if(up->cp || !nv_isattr(np,NV_INTEGER) || nv_type(np))
+		return;
+	if(nv_isattr(np,NV_DOUBLE)==NV_DOUBLE)
+		size = nv_isattr(np,NV_LONG) ? sizeof(Sfdouble_t) : sizeof(double);
+	else if(nv_isattr(np,NV_SHORT))
+		return;
+	else
+		size = nv_isattr(np,NV_LONG) ? sizeof(Sflong_t) : sizeof(int32_t);
+	if(!cp->num)
+	{
+		cp->num = sh_malloc(ARRAY_INCR*size);
+		cp->size = size;
+	}
+	else if(cp->size!=size)
+		return;
+	memset(cp->num+n*size,0,size);
+	up->cp = cp->num+n*size;
+}
+
+/* return the highest index with a value, or 0 */
+static int array_last(struct index_array *ap)
+{
+	struct array_chunk *cp;
+	int n = ap->maxi/ARRAY_INCR, i;
+	while(--n >= 0)
+	{
+		if(!(cp = ap->chunks[n]))
+			continue;
+		for(i=ARRAY_INCR; --i >= 0;)
+		{
+			if(cp->val[i].cp)
+				return n*ARRAY_INCR+i;
+		}
+	}
+	return 0;
+}
+
 static Namarr_t *array_scope(Namval_t *np, Namarr_t *ap, int flags)
 {
 	Namarr_t *aq;
@@ -91,7 +212,7 @@ static Namarr_t *array_scope(Namval_t *np, Namarr_t *ap, int flags)
 	aq->hdr.nofree |= (flags&NV_RDONLY)?1:0;
 	if(is_associative(aq))
 	{
-		aq->scope = dtopen(&_Nvdisc,Dtoset);
+		aq->scope = dtopen(&_Nvdisc,aq->table->meth);
 		dtview((Dt_t*)aq->scope,aq->table);
 		aq->table = (Dt_t*)aq->scope;
 		return aq;
@@ -110,8 +231,7 @@ static Namarr_t *array_scope(Namval_t *np, Namarr_t *ap, int flags)
 #endif /* SHOPT_FIXEDARRAY */
 	aq->scope = ap;
 	ar = (struct index_array*)aq;
-	memset(ar->val, 0, ar->maxi*sizeof(char*));
-	ar->bits =  (unsigned char*)&ar->val[ar->maxi];
+	ar->chunks = sh_newof(NULL,struct array_chunk*,ar->maxi/ARRAY_INCR,0);
 	return aq;
 }
 
@@ -123,7 +243,11 @@ static int array_unscope(Namval_t *np,Namarr_t *ap)
 	if(is_associative(ap))
 		(*ap->fun)(np, NULL, NV_AFREE);
 	if((fp = nv_disc(np,(Namfun_t*)ap,NV_POP)) && !(fp->nofree&1))
+	{
+		if(!is_associative(ap) && !ap->fixed)
+			array_freechunks((struct index_array*)ap);
 		free(fp);
+	}
 	nv_delete(np,NULL,0);
 	return 1;
 }
@@ -138,27 +262,13 @@ static int array_covered(Namval_t *np, struct index_array *ap)
 	struct index_array *aq = (struct index_array*)ap->header.scope;
 	if(!ap->header.fun && aq)
 #if SHOPT_FIXEDARRAY
-		return (ap->header.fixed || ((ap->cur<aq->maxi) && aq->val[ap->cur].cp));
+		return (ap->header.fixed || array_peek(aq,ap->cur));
 #else
-		return ((ap->cur<aq->maxi) && aq->val[ap->cur].cp);
+		return (array_peek(aq,ap->cur)!=0);
 #endif /* SHOPT_FIXEDARRAY */
 	return 0;
 }
 
-/*
- * replace discipline with new one
- */
-static void array_setptr(Namval_t *np, struct index_array *old, struct index_array *new)
-{
-	Namfun_t **fp = &np->nvfun;
-	while(*fp && *fp!= &old->header.hdr)
-		fp = &((*fp)->next);
-	if(!*fp)
-		abort();
-	new->header.hdr.next = (*fp)->next;
-	*fp = &new->header.hdr;
-}
-
 /*
  *   Calculate the amount of space to be allocated to hold an
  *   indexed array into which <maxi> is a legal index.  The number of
@@ -180,11 +290,9 @@ static struct index_array *array_grow(Namval_t*, struct index_array*,int);
 int array_maxindex(Namval_t *np)
 {
 	struct index_array *ap = (struct index_array*)nv_arrayptr(np);
-	int i = ap->maxi;
 	if(is_associative(ap))
 		return -1;
-	while(i>0 && ap->val[--i].cp==0);
-	return i+1;
+	return array_last(ap)+1;
 }
 
 static union Value *array_getup(Namval_t *np, Namarr_t *arp, int update)
@@ -228,8 +336,8 @@ static union Value *array_getup(Namval_t *np, Namarr_t *arp, int update)
 			errormsg(SH_DICT,ERROR_exit(1),e_subscript,nv_name(np));
 			UNREACHABLE();
 		}
-		up = &(ap->val[ap->cur]);
-		nofree = array_isbit(ap->bits,ap->cur,ARRAY_NOFREE);
+		up = array_slot(ap,ap->cur);
+		nofree = array_isbit(ap,ap->cur,ARRAY_NOFREE) || array_ispacked(array_chunk(ap,ap->cur),ap->cur&(ARRAY_INCR-1));
 	}
 	if(update)
 	{
@@ -247,9 +355,9 @@ int nv_arrayisset(Namval_t *np, Namarr_t *arp)
 	union Value *up;
 	if(is_associative(ap))
 		return (np = nv_opensub(np)) && !nv_isnull(np);
-	if(ap->cur >= ap->maxi)
+	if(!array_has(ap,ap->cur))
 		return 0;
-	up = &(ap->val[ap->cur]);
+	up = &array_val(ap,ap->cur);
 	if(up->cp==Empty)
 	{
 		Namfun_t *fp = &arp->hdr;
@@ -369,19 +477,19 @@ static Namval_t *array_find(Namval_t *np,Namarr_t *arp, int flag)
 			errormsg(SH_DICT,ERROR_exit(1),e_subscript,nv_name(np));
 			UNREACHABLE();
 		}
-		up = &(ap->val[ap->cur]);
+		up = array_slot(ap,ap->cur);
 		if((!up->cp||up->cp==Empty) && nv_type(np) && nv_isvtree(np))
 		{
 			char *cp;
 			if(!ap->header.table)
-				ap->header.table = dtopen(&_Nvdisc,Dtoset);
+				ap->header.table = dtopen(&_Nvdisc,Dtopset);
 			sfprintf(sh.strbuf,"%d",ap->cur);
 			cp = sfstruse(sh.strbuf);
 			mp = nv_search(cp, ap->header.table, NV_ADD);
 			mp->nvmeta = np;
 			nv_arraychild(np,mp,0);
 		}
-		if(up->np && array_isbit(ap->bits,ap->cur,ARRAY_CHILD))
+		if(up->np && array_isbit(ap,ap->cur,ARRAY_CHILD))
 		{
 			if(wasundef && nv_isarray(up->np))
 				nv_putsub(up->np,NULL,ARRAY_UNDEF);
@@ -409,7 +517,7 @@ int nv_arraysettype(Namval_t *np, Namval_t *tp, const char *sub, int flags)
 	Namarr_t	*ap = nv_arrayptr(np);
 	sh.last_table = 0;
 	if(!ap->table)
-		ap->table = dtopen(&_Nvdisc,Dtoset);
+		ap->table = dtopen(&_Nvdisc,Dtopset);
 	if(nq = nv_search(sub, ap->table, NV_ADD))
 	{
 		char	*saved_value = NULL;
@@ -470,7 +578,7 @@ static Namfun_t *array_clone(Namval_t *np, Namval_t *mp, int flags, Namfun_t *fp
 	}
 	if(ap->table)
 	{
-		ap->table = dtopen(&_Nvdisc,Dtoset);
+		ap->table = dtopen(&_Nvdisc,otable->meth);
 		if(ap->scope && !(flags&NV_COMVAR))
 		{
 			ap->scope = ap->table;
@@ -484,7 +592,20 @@ static Namfun_t *array_clone(Namval_t *np, Namval_t *mp, int flags, Namfun_t *fp
 		sub = sh_strdup(sub);
 	ar = (struct index_array*)ap;
 	if(!is_associative(ap))
-		ar->bits = (unsigned char*)&ar->val[ar->maxi];
+	{
+		array_copychunks(ar);
+		if(aq->xp)
+		{
+			/* the copy needs its own subscript converter; the original's is freed with it */
+			Namval_t *xq = nv_namptr(aq->xp,0);
+			ar->xp = sh_calloc(NV_MINSZ,1);
+			mq = nv_namptr(ar->xp,0);
+			mq->nvname = xq->nvname;
+			nv_onattr(mq,NV_MINIMAL);
+			nv_clone(xq,mq,NV_NOFREE);
+			nv_offattr(mq,NV_RDONLY);
+		}
+	}
 	if(!nv_putsub(np,NULL,ARRAY_SCAN|((flags&NV_COMVAR)?0:ARRAY_NOSCOPE)))
 	{
 		if(ap->fun)
@@ -503,13 +624,13 @@ static Namfun_t *array_clone(Namval_t *np, Namval_t *mp, int flags, Namfun_t *fp
 		{
 			mq->nvalue.cp = 0;
 			if(!is_associative(ap))
-				ar->val[ar->cur].np = mq;
+				array_slot(ar,ar->cur)->np = mq;
 			nv_clone(nq,mq,flags);
 		}
 		else if(flags&NV_ARRAY)
 		{
 			if((flags&NV_NOFREE) && !is_associative(ap))
-				array_setbit(aq->bits,aq->cur,ARRAY_NOFREE);
+				array_setbit(aq,aq->cur,ARRAY_NOFREE);
 			else if(nq && (flags&NV_NOFREE))
 			{
 				mq->nvalue = nq->nvalue;
@@ -520,13 +641,13 @@ static Namfun_t *array_clone(Namval_t *np, Namval_t *mp, int flags, Namfun_t *fp
 		{
 			Sfdouble_t d= nv_getnum(np);
 			if(!is_associative(ap))
-				ar->val[ar->cur].cp = 0;
+				array_clrval(ar,ar->cur);
 			nv_putval(mp,(char*)&d,NV_LDOUBLE);
 		}
 		else
 		{
 			if(!is_associative(ap))
-				ar->val[ar->cur].cp = 0;
+				array_clrval(ar,ar->cur);
 			nv_putval(mp,nv_getval(np),NV_RDONLY);
 		}
 		aq->header.nelem |= ARRAY_NOSCOPE;
@@ -599,7 +720,7 @@ static void array_putval(Namval_t *np, const char *string, int flags, Namfun_t *
 #endif /* SHOPT_FIXEDARRAY */
 	do
 	{
-		int xfree = (ap->fixed||is_associative(ap))?0:array_isbit(aq->bits,aq->cur,ARRAY_NOFREE);
+		int xfree = (ap->fixed||is_associative(ap))?0:array_isbit(aq,aq->cur,ARRAY_NOFREE);
 		mp = array_find(np,ap,string?ARRAY_ASSIGN:ARRAY_DELETE);
 		scan = ap->nelem&ARRAY_SCAN;
 		if(mp && mp!=np)
@@ -608,8 +729,8 @@ static void array_putval(Namval_t *np, const char *string, int flags, Namfun_t *
 			{
 				if(!nv_isattr(np,NV_NOFREE))
 					_nv_unset(mp,flags&NV_RDONLY);
-				array_clrbit(aq->bits,aq->cur,ARRAY_CHILD);
-				aq->val[aq->cur].cp = 0;
+				array_clrbit(aq,aq->cur,ARRAY_CHILD);
+				array_clrval(aq,aq->cur);
 				if(!nv_isattr(mp,NV_NOFREE))
 					nv_delete(mp,ap->table,0);
 				goto skip;
@@ -637,8 +758,8 @@ static void array_putval(Namval_t *np, const char *string, int flags, Namfun_t *
 				{
 					if(mp!=np)
 					{
-						array_clrbit(aq->bits,aq->cur,ARRAY_CHILD);
-						aq->val[aq->cur].cp = 0;
+						array_clrbit(aq,aq->cur,ARRAY_CHILD);
+						array_clrval(aq,aq->cur);
 						if(!xfree)
 							nv_delete(mp,ap->table,0);
 					}
@@ -686,6 +807,8 @@ static void array_putval(Namval_t *np, const char *string, int flags, Namfun_t *
 		if(nv_isarray(np))
 #endif /* SHOPT_FIXEDARRAY */
 			np->nvalue.up = up;
+		if(string && !ap->fixed && !is_associative(ap) && !(flags&(NV_NOREF|NV_NOFREE)))
+			array_pack(np,aq,up);
 		nv_putv(np,string,flags,&ap->hdr);
 		if(nofree && !up->cp)
 			up->cp = Empty;
@@ -703,9 +826,9 @@ static void array_putval(Namval_t *np, const char *string, int flags, Namfun_t *
 		if(!is_associative(ap))
 		{
 			if(string)
-				array_clrbit(aq->bits,aq->cur,ARRAY_NOFREE);
+				array_clrbit(aq,aq->cur,ARRAY_NOFREE);
 			else if(mp==np)
-				aq->val[aq->cur].cp = 0;
+				array_clrval(aq,aq->cur);
 		}
 		if(string && ap->hdr.type && nv_isvtree(np))
 			nv_arraysettype(np,ap->hdr.type,nv_getsub(np),0);
@@ -749,6 +872,8 @@ static void array_putval(Namval_t *np, const char *string, int flags, Namfun_t *
 		}
 		if((nfp = nv_disc(np,(Namfun_t*)ap,NV_POP)) && !(nfp->nofree&1))
 		{
+			if(!is_associative(ap) && !ap->fixed)
+				array_freechunks(aq);
 			ap = 0;
 			free(nfp);
 		}
@@ -799,6 +924,7 @@ static void array_copytree(Namval_t *np, Namval_t *mp)
  *        of the required size is allocated.  A pointer to the 
  *        allocated Namarr_t structure is returned.
  *        <maxi> becomes the current index of the array.
+ *        Only the table of blocks grows; the blocks are not copied.
  */
 static struct index_array *array_grow(Namval_t *np, struct index_array *arp,int maxi)
 {
@@ -810,30 +936,23 @@ static struct index_array *array_grow(Namval_t *np, struct index_array *arp,int
 		errormsg(SH_DICT,ERROR_exit(1),e_subscript,fmtint(maxi,1));
 		UNREACHABLE();
 	}
-	i = (newsize-1)*sizeof(union Value)+newsize;
-	ap = new_of(struct index_array,i);
-	memset(ap,0,sizeof(*ap)+i);
-	ap->maxi = newsize;
-	ap->cur = maxi;
-	ap->bits =  (unsigned char*)&ap->val[newsize];
-	memset(ap->bits, 0, newsize);
 	if(arp)
 	{
-		ap->header = arp->header;
-		ap->header.hdr.dsize = sizeof(*ap) + i;
-		for(i=0;i < arp->maxi;i++)
-		{
-			ap->bits[i] = arp->bits[i];
-			ap->val[i].cp = arp->val[i].cp;
-		}
-		memcpy(ap->bits, arp->bits, arp->maxi);
-		array_setptr(np,arp,ap);
-		free(arp);
+		ap = arp;
+		i = ap->maxi/ARRAY_INCR;
+		ap->chunks = sh_newof(ap->chunks,struct array_chunk*,newsize/ARRAY_INCR,0);
+		memset(&ap->chunks[i],0,(newsize/ARRAY_INCR-i)*sizeof(struct array_chunk*));
+		ap->maxi = newsize;
+		ap->cur = maxi;
 	}
 	else
 	{
 		Namval_t *mp=0;
-		ap->header.hdr.dsize = sizeof(*ap) + i;
+		ap = sh_newof(NULL,struct index_array,1,0);
+		ap->chunks = sh_newof(NULL,struct array_chunk*,newsize/ARRAY_INCR,0);
+		ap->maxi = newsize;
+		ap->cur = maxi;
+		ap->header.hdr.dsize = sizeof(*ap);
 		i = 0;
 		ap->header.fun = 0;
 		if((nv_isnull(np)||np->nvalue.cp==Empty) && nv_isattr(np,NV_NOFREE))
@@ -845,13 +964,13 @@ static struct index_array *array_grow(Namval_t *np, struct index_array *arp,int
 			np->nvalue.cp=0;
 		if(nv_hasdisc(np,&array_disc) || (nv_type(np) && nv_isvtree(np)))
 		{
-			ap->header.table = dtopen(&_Nvdisc,Dtoset);
+			ap->header.table = dtopen(&_Nvdisc,Dtopset);
 			mp = nv_search("0", ap->header.table,NV_ADD);
 			if(mp && nv_isnull(mp))
 			{
 				Namfun_t *fp;
-				ap->val[0].np = mp;
-				array_setbit(ap->bits,0,ARRAY_CHILD);
+				array_slot(ap,0)->np = mp;
+				array_setbit(ap,0,ARRAY_CHILD);
 				for(fp=np->nvfun; fp && !fp->disc->readf; fp=fp->next);
 				if(fp && fp->disc && fp->disc->readf)
 					(*fp->disc->readf)(mp,NULL,0,fp);
@@ -859,7 +978,7 @@ static struct index_array *array_grow(Namval_t *np, struct index_array *arp,int
 			}
 		}
 		else
-		if((ap->val[0].cp=np->nvalue.cp) || (nv_isattr(np,NV_INTEGER) && !nv_isnull(np)))
+		if((array_slot(ap,0)->cp=np->nvalue.cp) || (nv_isattr(np,NV_INTEGER) && !nv_isnull(np)))
 			i++;
 		ap->header.nelem = i;
 		ap->header.hdr.disc = &array_disc;
@@ -871,8 +990,6 @@ static struct index_array *array_grow(Namval_t *np, struct index_array *arp,int
 			ap->header.hdr.nofree &= ~1;
 		}
 	}
-	for(;i < newsize;i++)
-		ap->val[i].cp = 0;
 	return ap;
 }
 
@@ -937,7 +1054,9 @@ static Namarr_t *nv_changearray(Namval_t *np, void *(*fun)(Namval_t*,const char*
 
 	for(dot = 0; dot < (unsigned)save_ap->maxi; dot++)
 	{
-		if(save_ap->val[dot].cp)
+		if(!array_chunk(save_ap,dot))
+			dot |= ARRAY_INCR-1;
+		else if(array_val(save_ap,dot).cp)
 		{
 			if ((digit = dot)== 0)
 				*--string_index = '0';
@@ -948,11 +1067,18 @@ static Namarr_t *nv_changearray(Namval_t *np, void *(*fun)(Namval_t*,const char*
 			}
 			nv_putsub(np, string_index, ARRAY_ADD);
 			up = (union Value*)((*ap->fun)(np,NULL,0));
-			up->cp = save_ap->val[dot].cp;
-			save_ap->val[dot].cp = 0;
+			up->cp = array_val(save_ap,dot).cp;
+			if(array_ispacked(array_chunk(save_ap,dot),dot&(ARRAY_INCR-1)))
+			{
+				/* the packed storage is freed below */
+				size_t size = array_chunk(save_ap,dot)->size;
+				up->cp = memcpy(sh_malloc(size),up->cp,size);
+			}
+			array_val(save_ap,dot).cp = 0;
 		}
 		string_index = &numbuff[NUMSIZE];
 	}
+	array_freechunks(save_ap);
 	free(save_ap);
 	return ap;
 }
@@ -1042,7 +1168,7 @@ Namval_t *nv_arraychild(Namval_t *np, Namval_t *nq, int c)
 	if(!ap->fun)
 	{
 		struct index_array *aq = (struct index_array*)ap;
-		array_setbit(aq->bits,aq->cur,ARRAY_CHILD);
+		array_setbit(aq,aq->cur,ARRAY_CHILD);
 		if(c=='.' && !nq->nvalue.cp)
 			ap->nelem++;
 		up->np = nq;
@@ -1114,22 +1240,28 @@ int nv_nextsub(Namval_t *np)
 	for(dot=ap->cur+1; dot <  (unsigned)ap->maxi; dot++)
 	{
 		aq = ap;
-		if(!ap->val[dot].cp && !(ap->header.nelem&ARRAY_NOSCOPE))
+		if(!array_chunk(ap,dot) && !(ar && array_has(ar,dot)))
+		{
+			/* skip a block without elements */
+			dot |= ARRAY_INCR-1;
+			continue;
+		}
+		if(!array_peek(ap,dot) && !(ap->header.nelem&ARRAY_NOSCOPE))
 		{
-			if(!(aq=ar) || dot>=(unsigned)aq->maxi)
+			if(!(aq=ar) || !array_has(aq,dot))
 				continue;
 		}
-		if(aq->val[dot].cp==Empty && array_elem(&aq->header) < nv_aimax(np)+1)		{
+		if(array_peek(aq,dot)==Empty && array_elem(&aq->header) < nv_aimax(np)+1)		{
 			ap->cur = dot;
 			if(nv_getval(np)==Empty)
 				continue;
 		}
-		if(aq->val[dot].cp)
+		if(array_peek(aq,dot))
 		{
 			ap->cur = dot;
-			if(array_isbit(aq->bits, dot,ARRAY_CHILD))
+			if(array_isbit(aq, dot,ARRAY_CHILD))
 			{
-				Namval_t *mp = aq->val[dot].np;			
+				Namval_t *mp = array_val(aq,dot).np;			
 				if((aq->header.nelem&ARRAY_NOCHILD) && nv_isvtree(mp) && !mp->nvfun->dsize)
 					continue;
 				if(nv_isarray(mp))
@@ -1170,7 +1302,7 @@ Namval_t *nv_putsub(Namval_t *np,char *sp,long mode)
 			if(ap && ap->xp && !strmatch(sp,"+([0-9])"))
 			{
 				Namval_t *mp = nv_namptr(ap->xp,0);
-				nv_putval(mp, sp,0);
+				nv_putval(mp, sp,NV_RDONLY);	/* scratch node: not saved in virtual subshells */
 				size = nv_getnum(mp);
 			}
 			else
@@ -1192,7 +1324,8 @@ Namval_t *nv_putsub(Namval_t *np,char *sp,long mode)
 		{
 			if(size==0 && !(mode&ARRAY_FILL))
 				return NULL;
-			if(sh.subshell)
+			/* a new element is saved below */
+			if(sh.subshell && !(ap && (mode&ARRAY_ADD)))
 				sh_assignok(np,1);
 			ap = array_grow(np, ap,size);
 		}
@@ -1208,32 +1341,34 @@ Namval_t *nv_putsub(Namval_t *np,char *sp,long mode)
 				int n;
 				if(mode&ARRAY_SETSUB)
 				{
-					for(n=0; n <= ap->maxi; n++)
-						ap->val[n].cp = 0;
+					for(n=0; n < ap->maxi; n+=ARRAY_INCR)
+					{
+						if(array_chunk(ap,n))
+							memset(array_chunk(ap,n)->val,0,sizeof(array_chunk(ap,n)->val));
+					}
 					ap->header.nelem = 0;
 				}
 				for(n=0; n <= size; n++)
 				{
-					if(!ap->val[n].cp)
+					union Value *up = array_slot(ap,n);
+					if(!up->cp)
 					{
-						ap->val[n].cp = Empty;
+						up->cp = Empty;
 						if(!array_covered(np,ap))
 							ap->header.nelem++;
 					}
 				}
-				if(n=ap->maxi-ap->maxi)
-					memset(&ap->val[size],0,n*sizeof(union Value));
 			}
-			else if(!(sp=(char*)ap->val[size].cp) || sp==Empty)
+			else if(!(sp=(char*)array_peek(ap,size)) || sp==Empty)
 			{
 				if(sh.subshell)
-					sh_assignok(np,1);
+					sh_assignok(np,2);
 				if(ap->header.nelem&ARRAY_TREE)
 				{
 					char *cp;
 					Namval_t *mp;
 					if(!ap->header.table)
-						ap->header.table = dtopen(&_Nvdisc,Dtoset);
+						ap->header.table = dtopen(&_Nvdisc,Dtopset);
 					sfprintf(sh.strbuf,"%d",ap->cur);
 					cp = sfstruse(sh.strbuf);
 					mp = nv_search(cp, ap->header.table, NV_ADD);
@@ -1242,7 +1377,7 @@ Namval_t *nv_putsub(Namval_t *np,char *sp,long mode)
 					nv_setvtree(mp);
 				}
 				else if(!sh.cond_expan)
-					ap->val[size].cp = Empty;
+					array_slot(ap,size)->cp = Empty;
 				if(!sp && !array_covered(np,ap))
 					ap->header.nelem++;
 			}
@@ -1250,9 +1385,9 @@ Namval_t *nv_putsub(Namval_t *np,char *sp,long mode)
 		else if(!(mode&ARRAY_SCAN))
 		{
 			ap->header.nelem &= ~ARRAY_SCAN;
-			if(array_isbit(ap->bits,size,ARRAY_CHILD))
-				nv_putsub(ap->val[size].np,NULL,ARRAY_UNDEF);
-			if(sp && !(mode&ARRAY_ADD) && !ap->val[size].cp)
+			if(array_isbit(ap,size,ARRAY_CHILD))
+				nv_putsub(array_val(ap,size).np,NULL,ARRAY_UNDEF);
+			if(sp && !(mode&ARRAY_ADD) && !array_peek(ap,size))
 				np = 0;
 		}
 		return (Namval_t*)np;
@@ -1554,12 +1689,12 @@ Namval_t *nv_opensub(Namval_t* np)
 		if(is_associative(ap))
 			return (Namval_t*)((*ap->header.fun)(np,NULL,NV_ACURRENT));
 #if SHOPT_FIXEDARRAY
-		else if(!(fp=(struct fixed_array*)ap->header.fixed) && array_isbit(ap->bits,ap->cur,ARRAY_CHILD))
+		else if(!(fp=(struct fixed_array*)ap->header.fixed) && array_isbit(ap,ap->cur,ARRAY_CHILD))
 #else
-		else if(array_isbit(ap->bits,ap->cur,ARRAY_CHILD))
+		else if(array_isbit(ap,ap->cur,ARRAY_CHILD))
 #endif /* SHOPT_FIXEDARRAY */
 		{
-			return ap->val[ap->cur].np;
+			return array_val(ap,ap->cur).np;
 		}
 #if SHOPT_FIXEDARRAY
 		else if(fp)
@@ -1629,16 +1764,13 @@ int nv_aindex(Namval_t* np)
 int nv_aimax(Namval_t* np)
 {
 	struct index_array *ap = (struct index_array*)nv_arrayptr(np);
-	int sub = -1;
 #if SHOPT_FIXEDARRAY
 	if(!ap || is_associative(&ap->header) || ap->header.fixed)
 #else
 	if(!ap || is_associative(&ap->header))
 #endif /* SHOPT_FIXEDARRAY */
 		return -1;
-	sub = ap->maxi;
-	while(--sub>0 && ap->val[sub].cp==0);
-	return sub;
+	return array_last(ap);
 }
 
 /*
@@ -1652,7 +1784,7 @@ void *nv_associative(Namval_t *np,const char *sp,int mode)
 	{
 	    case NV_AINIT:
 		ap = (struct assoc_array*)sh_calloc(1,sizeof(struct assoc_array));
-		ap->header.table = dtopen(&_Nvdisc,Dtoset);
+		ap->header.table = dtopen(&_Nvdisc,Dtopset);
 		ap->cur = 0;
 		ap->pos = 0;
 		ap->header.hdr.disc = &array_disc;
@@ -1791,6 +1923,17 @@ void *nv_associative(Namval_t *np,const char *sp,int mode)
 	}
 }
 
+/*
+ * make the associative array <np> list its subscripts in the order
+ * in which they were added instead of in sorted order
+ */
+void nv_aorder(Namval_t *np)
+{
+	Namarr_t *ap = nv_arrayptr(np);
+	if(ap && array_assoc(ap) && ap->table && ap->table->meth!=Dtpset)
+		dtmethod(ap->table,Dtpset);
+}
+
 /*
  * Assign values to an array
  */
@@ -1813,8 +1956,9 @@ void nv_setvec(Namval_t *np,int append,int argc,char *argv[])
 		{
 			if(!(aq = (struct index_array*)ap->header.scope))
 				aq = ap;
-			arg0 = ap->maxi;
-			while(--arg0>0 && ap->val[arg0].cp==0 && aq->val[arg0].cp==0);
+			arg0 = array_last(ap);
+			if(aq!=ap && array_last(aq) > arg0)
+				arg0 = array_last(aq);
 			arg0++;
 		}
 		else
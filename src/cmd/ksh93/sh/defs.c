@@ -32,7 +32,7 @@ Shell_t			sh = {0};
 
 Dtdisc_t	_Nvdisc =
 {
-	offsetof(Namval_t,nvname), -1 , 0, 0, 0, nv_compare
+	offsetof(Namval_t,nvname), -1 , 0, 0, 0, 0
 };
 
 /* reserve room for writable state table */
@@ -97,6 +97,7 @@ void	sh_fault(int sig)
 	&& sig!=SIGCONT)
 	{
 		sh.exitval = SH_EXITSIG|sig;
+		sh_stats(STAT_SFSIGNAL);
 		sh_subfork();
 		sh.exitval = 0;
 		goto done;
@@ -603,7 +604,10 @@ void sh_exit(int xno)
 		else
 		{
 			if(sh.subshell)
+			{
+				sh_stats(STAT_SFSIGNAL);
 				sh_subfork();
+			}
 			/* script or child process; put to sleep */
 			sh_offstate(SH_STOPOK);
 			sh_offstate(SH_MONITOR);
@@ -675,6 +679,9 @@ noreturn void sh_done(int sig)
 		sh_chktrap();
 	}
 	nv_scan(sh.var_tree,array_notify,NULL,NV_ARRAY,NV_ARRAY);
+#if SHOPT_STATS
+	sh_profdone();
+#endif /* SHOPT_STATS */
 	sh_freeup();
 #if SHOPT_ACCT
 	sh_accend();
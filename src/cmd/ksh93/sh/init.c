@@ -1383,6 +1383,7 @@ Shell_t *sh_init(int argc,char *argv[], Shinit_f userinit)
 	}
 	/* increase SHLVL */
 	shlvl++;
+	env_change();
 #if SHOPT_SPAWN
 	{
 		/*
@@ -1687,6 +1688,7 @@ void sh_reinit(void)
 #if SHOPT_STATS
 	free(sh.stats);
 	sh.stats = NULL;
+	sh.profile = NULL;
 #endif
 	/* Re-init variables, functions and built-ins */
 	free(sh.bltin_cmds);
@@ -1698,6 +1700,7 @@ void sh_reinit(void)
 	env_init();
 	/* Increase SHLVL */
 	shlvl++;
+	env_change();
 	/* call user init function, if any */
 	if(sh.userinit)
 		(*sh.userinit)(&sh, 1);
@@ -1793,7 +1796,7 @@ static Namfun_t	 stat_child_fun =
 
 static void stat_init(void)
 {
-	int		i,nstat = STAT_SUBSHELL+1;
+	int		i,nstat = STAT_NUMSTATS;
 	size_t		extrasize = nstat*(sizeof(int)+NV_MINSZ);
 	struct Stats	*sp = sh_newof(0,struct Stats,1,extrasize);
 	Namval_t	*np;
@@ -1940,6 +1943,7 @@ static Init_t *nv_init(void)
 #if SHOPT_STATS
 	if(!sh.stats)
 		stat_init();
+	sh_profinit();
 #endif
 	return ip;
 }
@@ -1155,6 +1155,7 @@ int	sh_redirect(struct ionod *iop, int flag)
 				continue;
 			if(!sh.subshare)
 			{
+				sh_stats(STAT_SFREDIR);
 				sh_subfork();
 				break;
 			}
@@ -1386,6 +1387,8 @@ int	sh_redirect(struct ionod *iop, int flag)
 						errormsg(SH_DICT,ERROR_system(1),((o_mode&O_CREAT)?e_create:e_open),fname);
 						UNREACHABLE();
 					}
+					if(o_mode&O_CREAT)
+						path_dirchange();
 					if(perm>0)
 #if _lib_fchmod
 						fchmod(fd,perm);
@@ -51,6 +51,7 @@
 #include	"defs.h"
 #include	<wait.h>
 #include	"io.h"
+#include	"path.h"
 #include	"jobs.h"
 #include	"history.h"
 
@@ -71,16 +72,29 @@
 /*
  * This struct saves a link list of processes that have non-zero exit
  * status, have had $! saved, but haven't been waited for
+ * Each entry is also on a hash chain keyed by process ID
  */
 struct jobsave
 {
 	struct jobsave	*next;
+	struct jobsave	*prev;
+	struct jobsave	*hnext;
 	pid_t		pid;
+	int		level;		/* level of the owning back_save */
 	unsigned short	exitval;
 };
 
 static struct jobsave *job_savelist;
 static int njob_savelist;
+static struct jobsave **savehash;
+static unsigned int savehsize, savehcount;
+static char saverehash;		/* outer level statuses not yet hashed in a forked child */
+static struct process **prochash;
+static unsigned int prochsize, prochcount;
+static struct process **jobtab;
+static int njobtab;
+
+#define PIDHASH(pid,size)	((unsigned int)(pid)&((size)-1))
 static struct process *pwfg;
 static int jobfork;
 
@@ -116,7 +130,9 @@ static void init_savelist(void)
 struct back_save
 {
 	int		count;
+	int		level;
 	struct jobsave	*list;
+	struct jobsave	*tail;
 	struct back_save *prev;
 };
 
@@ -161,6 +177,7 @@ static int		job_alloc(void);
 static void		job_free(int);
 static struct process	*job_unpost(struct process*,int);
 static void		job_unlink(struct process*);
+static void		job_push(struct process*);
 static void		job_prmsg(struct process*);
 static struct process	*freelist;
 static char		beenhere;
@@ -223,6 +240,71 @@ void job_chldtrap(int unpost)
 }
 #endif /* SHOPT_BGX */
 
+/*
+ * add <jp> to the saved exit status hash table, doubling it when full
+ * the split keeps the order of each chain
+ */
+static void jobsave_hash(struct jobsave *jp)
+{
+	struct jobsave **hp;
+	if(savehcount >= savehsize)
+	{
+		unsigned int i, n = savehsize ? 2*savehsize : 64;
+		struct jobsave **tab = sh_newof(0,struct jobsave*,n,0), **lo, **hi, *xp;
+		for(i=0; i < savehsize; i++)
+		{
+			lo = &tab[i];
+			hi = &tab[i+savehsize];
+			for(xp=savehash[i]; xp; xp=xp->hnext)
+			{
+				if(PIDHASH(xp->pid,n)==i)
+				{
+					*lo = xp;
+					lo = &xp->hnext;
+				}
+				else
+				{
+					*hi = xp;
+					hi = &xp->hnext;
+				}
+			}
+			*lo = *hi = 0;
+		}
+		free(savehash);
+		savehash = tab;
+		savehsize = n;
+	}
+	hp = &savehash[PIDHASH(jp->pid,savehsize)];
+	jp->hnext = *hp;
+	*hp = jp;
+	savehcount++;
+}
+
+static void jobsave_unhash(struct jobsave *jp)
+{
+	struct jobsave **hp = &savehash[PIDHASH(jp->pid,savehsize)];
+	while(*hp != jp)
+		hp = &(*hp)->hnext;
+	*hp = jp->hnext;
+	savehcount--;
+}
+
+/*
+ * hash the saved statuses of the outer subshell levels that a forked
+ * child inherited, deferred by job_clear() until they are needed
+ */
+static void jobsave_rehash(void)
+{
+	struct back_save *bp;
+	struct jobsave *jp;
+	if(!saverehash)
+		return;
+	saverehash = 0;
+	for(bp=bck.prev; bp; bp=bp->prev)
+		for(jp=bp->list; jp; jp=jp->next)
+			jobsave_hash(jp);
+}
+
 /*
  * return next on link list of jobsave free list
  */
@@ -242,13 +324,89 @@ static struct jobsave *jobsave_create(pid_t pid)
 	if(jp)
 	{
 		jp->pid = pid;
-		jp->next = bck.list;
+		jp->level = bck.level;
+		jp->prev = 0;
+		if(jp->next = bck.list)
+			bck.list->prev = jp;
+		else
+			bck.tail = jp;
 		bck.list = jp;
 		jp->exitval = 0;
+		jobsave_hash(jp);
 	}
 	return jp;
 }
 
+/*
+ * add process <pw> to the process ID hash table, doubling it when full
+ * the split keeps the order of each chain so the latest of several
+ * processes with the same ID is still found first
+ */
+static void proc_hash(struct process *pw)
+{
+	struct process **hp;
+	if(prochcount >= prochsize)
+	{
+		unsigned int i, n = prochsize ? 2*prochsize : 64;
+		struct process **tab = sh_newof(0,struct process*,n,0), **lo, **hi, *px;
+		for(i=0; i < prochsize; i++)
+		{
+			lo = &tab[i];
+			hi = &tab[i+prochsize];
+			for(px=prochash[i]; px; px=px->p_nxthash)
+			{
+				if(PIDHASH(px->p_pid,n)==i)
+				{
+					*lo = px;
+					lo = &px->p_nxthash;
+				}
+				else
+				{
+					*hi = px;
+					hi = &px->p_nxthash;
+				}
+			}
+			*lo = *hi = 0;
+		}
+		free(prochash);
+		prochash = tab;
+		prochsize = n;
+	}
+	hp = &prochash[PIDHASH(pw->p_pid,prochsize)];
+	pw->p_nxthash = *hp;
+	*hp = pw;
+	prochcount++;
+}
+
+static void proc_unhash(struct process *pw)
+{
+	struct process **hp = &prochash[PIDHASH(pw->p_pid,prochsize)];
+	while(*hp && *hp != pw)
+		hp = &(*hp)->p_nxthash;
+	if(*hp)
+	{
+		*hp = pw->p_nxthash;
+		prochcount--;
+	}
+}
+
+/*
+ * make <pw> the head process of its job in the job number index
+ */
+static void job_settab(struct process *pw)
+{
+	if(pw->p_job >= njobtab)
+	{
+		int n = njobtab ? njobtab : 16;
+		while(n <= pw->p_job)
+			n *= 2;
+		jobtab = sh_newof(jobtab,struct process*,n,0);
+		memset(&jobtab[njobtab],0,(n-njobtab)*sizeof(struct process*));
+		njobtab = n;
+	}
+	jobtab[pw->p_job] = pw;
+}
+
 /*
  * Reap one job
  * When called with sig==0, it does a blocking wait
@@ -318,6 +476,7 @@ int job_reap(int sig)
 			job_chksave(pid);
 		flags |= WNOHANG;
 		job.waitsafe++;
+		path_dirchange();
 		jp = 0;
 		lastpid = pid;
 		if(!(pw=job_bypid(pid)))
@@ -357,8 +516,7 @@ int job_reap(int sig)
 			{
 				/* move to top of job list */
 				job_unlink(px);
-				px->p_nxtjob = job.pwlist;
-				job.pwlist = px;
+				job_push(px);
 			}
 			continue;
 		}
@@ -746,15 +904,116 @@ static void job_reset(struct process *pw)
 	beenhere = 0;
 }
 
+/*
+ * wait -n: wait for the next of the given <jobs> to complete, or for the next
+ * of all jobs if none are given, and set the exit status to that of this job
+ * a job that has already completed but has not been waited for is taken first
+ */
+static void job_waitnext(char **jobs)
+{
+	struct process *pw, *px, *pwdone;
+	char **argv;
+	int *jobids = 0, n = 0, i, found, nochild = 0;
+	if(*jobs)
+	{
+		for(argv=jobs; *argv; argv++);
+		jobids = (int*)stkalloc(sh.stk,(argv-jobs)*sizeof(int));
+		for(argv=jobs; *argv; argv++)
+		{
+			if(**argv=='%')
+			{
+				job_lock();
+				pw = job_bystring(*argv);
+				job_unlock();
+			}
+			else
+			{
+				pid_t pid = pid_fromstring(*argv);
+				job_lock();
+				if(!(pw=job_bypid(pid)) && (i=job_chksave(pid)) >= 0)
+				{
+					/* already reaped and unposted */
+					job_unlock();
+					sh.exitval = i;
+					exitset();
+					return;
+				}
+				job_unlock();
+			}
+			if(pw)
+				jobids[n++] = pw->p_job;
+		}
+		if(n==0)
+		{
+			sh.exitval = ERROR_NOENT;
+			exitset();
+			return;
+		}
+	}
+	job_lock();
+	while(1)
+	{
+		pwdone = 0;
+		found = 0;
+		for(pw=job.pwlist; pw; pw=pw->p_nxtjob)
+		{
+			if(pw->p_env!=sh.curenv)
+				continue;
+			if(jobids)
+			{
+				for(i=0; i < n && jobids[i]!=pw->p_job; i++);
+				if(i==n)
+					continue;
+			}
+			found = 1;
+			for(px=pw; px && (px->p_flag&P_DONE); px=px->p_nxtproc);
+			if(!px)
+				pwdone = pw;
+		}
+		if(pwdone || !found)
+			break;
+		job.waitsafe = 0;
+		nochild = job_reap(job.savesig);
+		if(job.waitsafe)
+			continue;
+		if(nochild || sh.trapnote)
+			break;
+	}
+	if(pw = pwdone)
+	{
+		/* the first process in the list is the last one in the pipeline */
+		sh.exitval = pw->p_exit;
+		if(pw->p_flag&P_SIGNALLED)
+		{
+			sh.exitval |= SH_EXITSIG;
+			sh.chldexitsig = 1;
+			pw->p_flag &= ~P_NOTIFY;
+			job_prmsg(pw);
+		}
+		for(px=pw; px; px=px->p_nxtproc)
+			px->p_flag &= ~P_EXITSAVE;
+		job_unpost(pw,1);
+	}
+	else if(!found || nochild)
+		sh.exitval = ERROR_NOENT;
+	else
+		sh.exitval = 1;
+	job_unlock();
+	exitset();
+}
+
 /*
  * wait built-in command
+ * <next> is set for wait -n
  */
-void job_bwait(char **jobs)
+void job_bwait(char **jobs, int next)
 {
 	char *jp;
 	struct process *pw;
 	pid_t pid;
-	if(*jobs==0)
+	if(next)
+		job_waitnext(jobs);
+	else if(*jobs==0)
 		job_wait((pid_t)-1);
 	else while(jp = *jobs++)
 	{
@@ -1115,21 +1374,46 @@ void	job_clear(void)
 	int j = BYTE(sh.lim.child_max);
 	struct jobsave *jp,*jpnext;
 	job_lock();
-	for(pw=job.pwlist; pw; pw=pwnext)
+	if(job.toclear)
 	{
-		pwnext = pw->p_nxtjob;
-		while(px=pw)
-		{
-			pw = pw->p_nxtproc;
-			free(px);
-		}
+		/*
+		 * In a newly forked child the tables are the parent's copy-on-write
+		 * pages; abandon them instead of touching every entry to free it
+		 */
+		prochash = 0;
+		prochsize = prochcount = 0;
+		jobtab = 0;
+		njobtab = 0;
+		savehash = 0;
+		savehsize = savehcount = 0;
+		/* the saved statuses of outer subshell levels are hashed on first use */
+		saverehash = bck.prev!=0;
 	}
-	for(jp=bck.list; jp;jp=jpnext)
+	else
 	{
-		jpnext = jp->next;
-		free(jp);
+		for(pw=job.pwlist; pw; pw=pwnext)
+		{
+			pwnext = pw->p_nxtjob;
+			while(px=pw)
+			{
+				pw = pw->p_nxtproc;
+				free(px);
+			}
+		}
+		for(jp=bck.list; jp;jp=jpnext)
+		{
+			jpnext = jp->next;
+			jobsave_unhash(jp);
+			free(jp);
+		}
+		if(prochsize)
+			memset(prochash,0,prochsize*sizeof(struct process*));
+		prochcount = 0;
+		if(njobtab)
+			memset(jobtab,0,njobtab*sizeof(struct process*));
 	}
-	bck.list = 0;
+	bck.list = bck.tail = 0;
+	bck.count = 0;
 	if(njob_savelist < NJOB_SAVELIST)
 		init_savelist();
 	job.pwlist = NULL;
@@ -1187,8 +1471,7 @@ int job_post(pid_t pid, pid_t join)
 		if(val && (pw=job_byjid(val)) != job.pwlist)
 		{
 			job_unlink(pw);
-			pw->p_nxtjob = job.pwlist;
-			job.pwlist = pw;
+			job_push(pw);
 		}
 	}
 	if(pw=freelist)
@@ -1200,22 +1483,26 @@ int job_post(pid_t pid, pid_t join)
 	if(join && job.pwlist)
 	{
 		/* join existing current job */
-		pw->p_nxtjob = job.pwlist->p_nxtjob;
+		if(pw->p_nxtjob = job.pwlist->p_nxtjob)
+			pw->p_nxtjob->p_prvjob = pw;
+		pw->p_prvjob = 0;
 		pw->p_nxtproc = job.pwlist;
 		pw->p_job = job.pwlist->p_job;
+		job.pwlist = pw;
+		job_settab(pw);
 	}
 	else
 	{
 		/* create a new job */
 		while((pw->p_job = job_alloc()) < 0)
 			job_wait((pid_t)1);
-		pw->p_nxtjob = job.pwlist;
 		pw->p_nxtproc = 0;
+		job_push(pw);
 	}
 	pw->p_exitval = job.exitval; 
-	job.pwlist = pw;
 	pw->p_env = sh.curenv;
 	pw->p_pid = pid;
+	proc_hash(pw);
 	if(!sh.outpipe || sh.cpid==pid)
 		pw->p_flag = P_EXITSAVE;
 	pw->p_exitmin = sh.xargexit;
@@ -1273,13 +1560,14 @@ int job_post(pid_t pid, pid_t join)
  */
 static struct process *job_bypid(pid_t pid)
 {
-	struct process  *pw, *px;
-	for(pw=job.pwlist; pw; pw=pw->p_nxtjob)
-		for(px=pw; px; px=px->p_nxtproc)
-		{
-			if(px->p_pid==pid)
-				return px;
-		}
+	struct process  *pw;
+	if(!prochsize)
+		return NULL;
+	for(pw=prochash[PIDHASH(pid,prochsize)]; pw; pw=pw->p_nxthash)
+	{
+		if(pw->p_pid==pid)
+			return pw;
+	}
 	return NULL;
 }
 
@@ -1288,13 +1576,9 @@ static struct process *job_bypid(pid_t pid)
  */
 static struct process *job_byjid(int jobid)
 {
-	struct process *pw;
-	for(pw=job.pwlist;pw; pw = pw->p_nxtjob)
-	{
-		if(pw->p_job==jobid)
-			break;
-	}
-	return pw;
+	if(jobid <= 0 || jobid >= njobtab)
+		return NULL;
+	return jobtab[jobid];
 }
 
 /*
@@ -1549,8 +1833,7 @@ int job_switch(struct process *pw,int bgflag)
 	else
 	{
 		job_unlink(pw);
-		pw->p_nxtjob = job.pwlist;
-		job.pwlist = pw;
+		job_push(pw);
 		msg = "";
 	}
 	hist_list(sh.hist_ptr,outfile,pw->p_name,'&',";");
@@ -1655,6 +1938,7 @@ static struct process *job_unpost(struct process *pwtop,int notify)
 		}
 		pw->p_flag &= ~P_DONE;
 		job.numpost--;
+		proc_unhash(pw);
 		pw->p_nxtjob = freelist;
 		freelist = pw;
 	}
@@ -1672,19 +1956,28 @@ static struct process *job_unpost(struct process *pwtop,int notify)
  */
 static void job_unlink(struct process *pw)
 {
-	struct process *px;
+	if(pw->p_nxtjob)
+		pw->p_nxtjob->p_prvjob = pw->p_prvjob;
 	if(pw==job.pwlist)
 	{
 		job.pwlist = pw->p_nxtjob;
 		job.curpgid = 0;
 		return;
 	}
-	for(px=job.pwlist;px;px=px->p_nxtjob)
-		if(px->p_nxtjob == pw)
-		{
-			px->p_nxtjob = pw->p_nxtjob;
-			return;
-		}
+	if(pw->p_prvjob)
+		pw->p_prvjob->p_nxtjob = pw->p_nxtjob;
+}
+
+/*
+ * put job <pw> at the front of the job list
+ */
+static void job_push(struct process *pw)
+{
+	if(pw->p_nxtjob = job.pwlist)
+		job.pwlist->p_prvjob = pw;
+	pw->p_prvjob = 0;
+	job.pwlist = pw;
+	job_settab(pw);
 }
 
 /*
@@ -1723,8 +2016,11 @@ static int job_alloc(void)
  */
 static void job_free(int n)
 {
-	int j = (--n)/CHAR_BIT;
+	int j;
 	unsigned mask;
+	if(n < njobtab)
+		jobtab[n] = 0;
+	j = (--n)/CHAR_BIT;
 	n -= j*CHAR_BIT;
 	mask = 1 << n;
 	job.freejobs[j]  &= ~mask;
@@ -1757,36 +2053,40 @@ static char *job_sigmsg(int sig)
  */
 static int job_chksave(pid_t pid)
 {
-	struct jobsave *jp = bck.list, *jpold=0;
+	struct jobsave *jp;
 	int r= -1;
-	int count=bck.count;
 	struct back_save *bp= &bck;
-again:
-	while(jp && count-->0)
-	{
-		if(jp->pid==pid)
-			break;
-		if(pid==0 && !jp->next)
-			break;
-		jpold = jp;
-		jp = jp->next;
-	}
-	if(!jp && pid && (bp=bp->prev))
+	jobsave_rehash();
+	if(pid==0)
+		jp = bck.tail;
+	else
 	{
-		count = bp->count;
-		jp = bp->list;
-		jpold = 0;
-		goto again;
+		for(jp=savehsize?savehash[PIDHASH(pid,savehsize)]:0; jp; jp=jp->hnext)
+			if(jp->pid==pid)
+				break;
+		/* find the subshell level that owns it */
+		if(jp)
+		{
+			while(bp && bp->level != jp->level)
+				bp = bp->prev;
+			if(!bp)
+				return -1;
+		}
 	}
 	if(jp)
 	{
 		r = 0;
 		if(pid)
 			r = jp->exitval;
-		if(jpold)
-			jpold->next = jp->next;
+		jobsave_unhash(jp);
+		if(jp->prev)
+			jp->prev->next = jp->next;
 		else
 			bp->list = jp->next;
+		if(jp->next)
+			jp->next->prev = jp->prev;
+		else
+			bp->tail = jp->prev;
 		bp->count--;
 		if(njob_savelist < NJOB_SAVELIST)
 		{
@@ -1804,10 +2104,12 @@ void *job_subsave(void)
 {
 	struct back_save *bp = new_of(struct back_save,0);
 	job_lock();
+	jobsave_rehash();
 	*bp = bck;
 	bp->prev = bck.prev;
 	bck.count = 0;
-	bck.list = 0;
+	bck.list = bck.tail = 0;
+	bck.level++;
 	bck.prev = bp;
 	job_unlock();
 	return bp;
@@ -1818,18 +2120,21 @@ void job_subrestore(void* ptr)
 	struct jobsave *jp;
 	struct back_save *bp = (struct back_save*)ptr;
 	struct process *pw, *px, *pwnext;
-	struct jobsave *end=NULL;
 	job_lock();
+	jobsave_rehash();
 	for(jp=bck.list; jp; jp=jp->next)
+		jp->level = bp->level;
+	if(bck.tail)
 	{
-		if (!jp->next)
-			end = jp;
+		if(bck.tail->next = bp->list)
+			bp->list->prev = bck.tail;
 	}
-	if(end)
-		end->next = bp->list;
 	else
 		bck.list = bp->list;
+	if(bp->tail)
+		bck.tail = bp->tail;
 	bck.count += bp->count;
+	bck.level = bp->level;
 	bck.prev = bp->prev;
 	while(bck.count > sh.lim.child_max)
 		job_chksave(0);
@@ -2450,6 +2450,7 @@ static void setupalias(Lex_t *lp, const char *string,Namval_t *np)
 {
 	Sfio_t *iop, *base;
 	struct alias *ap = (struct alias*)sh_malloc(sizeof(struct alias));
+	sh.aliasexp++;
 	ap->disc = alias_disc;
 	ap->lp = lp;
 	ap->buf[1] = 0;
@@ -84,6 +84,11 @@ typedef struct  _mac_
 #define isqescchar(s)	((s)>=S_QUOTE)
 #define isbracechar(c)	((c)==RBRACE || (_c_=sh_lexstates[ST_BRACE][c])==S_MOD1 ||_c_==S_MOD2)
 #define ltos(x)		fmtint(x,0)
+#if SHOPT_FILESCAN
+#define isreply(np)	(sh.cur_line && (np)==REPLYNOD)	/* $REPLY in a 'while <file' loop */
+#else
+#define isreply(np)	0
+#endif /* SHOPT_FILESCAN */
 
 /* type of macro expansions */
 #define M_BRACE		1	/* ${var}	*/
@@ -952,30 +957,24 @@ static void mac_substitute(Mac_t *mp, char *cp,char *str,int subexp[],int subsiz
 }
 
 #if  SHOPT_FILESCAN
-#define	MAX_OFFSETS	 (sizeof(sh.offsets)/sizeof(sh.offsets[0]))
-#define MAX_ARGN	(32*1024)
-
 /*
- * compute the arguments $1 ... $n and $# from the current line as needed
- * save line offsets in the offsets array.
+ * split the current line of the innermost 'while <file' loop into fields
+ * and make them the positional parameters until the next line is read
  */
-static char *getdolarg(int n, int *size)
+void sh_scanargs(void)
 {
-	int c=S_DELIM, d=sh.ifstable['\\'];
-	unsigned char *first,*last,*cp = (unsigned char*)sh.cur_line;
-	int m=sh.offsets[0],delim=0;
-	if(m==0)
-		return NULL;
-	if(m<0)
-		m = 0;
-	else if(n<=m)
-		m = n-1;
-	else
-		m--;
-	if(m >= MAX_OFFSETS-1)
-		m =  MAX_OFFSETS-2;
-	cp += sh.offsets[m+1];
-	n -= m;
+	struct Filescan	*fp = sh.filescan;
+	unsigned char	*cp, *first, *last;
+	size_t		n = strlen(sh.cur_line)+1;
+	int		c=S_DELIM, d, argc=0;
+	nv_getval(sh_scoped(IFSNOD));	/* update sh.ifstable */
+	if(n > fp->bufsize)
+	{
+		fp->bufsize = roundof(n,256);
+		fp->buf = sh_realloc(fp->buf,fp->bufsize);
+	}
+	cp = (unsigned char*)memcpy(fp->buf,sh.cur_line,n);
+	d = sh.ifstable['\\'];
 	sh.ifstable['\\'] = 0;
 	sh.ifstable[0] = S_EOF;
 	while(1)
@@ -983,31 +982,31 @@ static char *getdolarg(int n, int *size)
 		if(c==S_DELIM)
 			while(sh.ifstable[*cp++]==S_SPACE);
 		first = --cp;
-		if(++m < MAX_OFFSETS)
-			sh.offsets[m] = (first-(unsigned char*)sh.cur_line);
 		while((c=sh.ifstable[*cp++])==0);
 		last = cp-1;
 		if(c==S_SPACE)
 			while((c=sh.ifstable[*cp++])==S_SPACE);
-		if(--n==0 || c==S_EOF)
-		{
-			if(last==first && c==S_EOF && (!delim || (m>1)))
-			{
-				n++;
-				m--;
-			}
+		/* an empty last field is not a field */
+		if(c==S_EOF && last==first)
 			break;
+		if(argc+2 >= fp->argmax)
+		{
+			fp->argmax = argc + 16;
+			fp->argv = sh_newof(fp->argv,char*,fp->argmax,0);
 		}
-		delim = (c==S_DELIM);
+		fp->argv[++argc] = (char*)first;
+		*last = 0;
+		if(c==S_EOF)
+			break;
 	}
 	sh.ifstable['\\'] = d;
-	if(m > sh.offsets[0])
-		sh.offsets[0] = m;
-	if(n)
-		first = last = 0;
-	if(size)
-		*size = last-first;
-	return (char*)first;
+	if(!fp->argv)
+		fp->argv = sh_newof(0,char*,fp->argmax=2,0);
+	fp->argv[0] = sh.st.dolv[0];
+	fp->argv[argc+1] = NULL;
+	fp->dolc = sh.st.dolc;
+	sh.st.dolv = fp->argv;
+	sh.st.dolc = argc;
 }
 #endif /* SHOPT_FILESCAN */
 
@@ -1201,19 +1200,6 @@ retry1:
 		if(isastchar(c))
 		{
 			mode = c;
-#if  SHOPT_FILESCAN
-			if(sh.cur_line)
-			{
-				dolmax = MAX_ARGN;
-				v = getdolarg(1,&vsize);
-				if(c=='*' || !mp->quoted)
-				{
-					dolmax = 1;
-					vsize = -1;
-				}
-			}
-			else
-#endif  /* SHOPT_FILESCAN */
 			dolmax = sh.st.dolc+1;
 			mp->atmode = (v && mp->quoted && c=='@');
 			dolg = (v!=0);
@@ -1241,15 +1227,12 @@ retry1:
 			fcseek(-1);
 		}
 		idnum = c;
-		if(c==0)
-			v = special(c);
 #if  SHOPT_FILESCAN
-		else if(sh.cur_line)
-		{
-			sh.used_pos = 1;
-			v = getdolarg(c,&vsize);
-		}
+		if(c && sh_scanpending())
+			sh_scanargs();
 #endif  /* SHOPT_FILESCAN */
+		if(c==0)
+			v = special(c);
 		else if(c <= sh.st.dolc)
 		{
 			sh.used_pos = 1;
@@ -1405,11 +1388,7 @@ retry1:
 		{
 			if(nv_isattr(np,NV_NOFREE))
 				nv_offattr(np,NV_NOFREE);
-#if  SHOPT_FILESCAN
-			else if(np!=REPLYNOD  || !sh.cur_line)
-#else
-			else
-#endif  /* SHOPT_FILESCAN */
+			else if(!isreply(np))
 				np = 0;
 		}
 		np_orig = np;
@@ -1481,7 +1460,7 @@ retry1:
 		 */
 		if(np && type==M_BRACE && nv_getoptimize())
 			nv_optimize(np);  /* needed before calling nv_isnull() */
-		if(np && (type==M_BRACE ? !nv_isnull(np) : (type==M_TREE || !c || !ap)))
+		if(np && (type==M_BRACE ? !nv_isnull(np) || isreply(np) : (type==M_TREE || !c || !ap)))
 		{
 			/* Either the parameter is set, or it's a special type of expansion where 'unset' doesn't apply. */
 			void *savptr;
@@ -1508,10 +1487,8 @@ retry1:
 					nv_attribute(np,sh.strbuf,"typeset",1);
 				v = sfstruse(sh.strbuf);
 			}
-#if  SHOPT_FILESCAN
-			else if(sh.cur_line && np==REPLYNOD)
+			else if(isreply(np))
 				v = sh.cur_line;
-#endif  /* SHOPT_FILESCAN */
 			else if(type==M_TREE)
 				v = nv_getvtree(np,NULL);
 			else
@@ -1625,14 +1602,6 @@ retry1:
 				c = charlen(v,vsize);
 			else if(dolg>0)
 			{
-#if  SHOPT_FILESCAN
-				if(sh.cur_line)
-				{
-					getdolarg(MAX_ARGN,NULL);
-					c = sh.offsets[0];
-				}
-				else
-#endif  /* SHOPT_FILESCAN */
 				c = sh.st.dolc;
 			}
 			else if(dolg<0)
@@ -1750,14 +1719,6 @@ retry1:
 					sliceoffset = 0;
 				if(sliceoffset==0)
 					v = special(dolg=0);
-#if  SHOPT_FILESCAN
-				else if(sh.cur_line)
-				{
-					v = getdolarg(dolg = sliceoffset, &vsize);
-					if(!v)
-						dolmax = sliceoffset;
-				}
-#endif  /* SHOPT_FILESCAN */
 				else if(sliceoffset < dolmax)
 					v = sh.st.dolv[dolg = sliceoffset];
 				else
@@ -1992,17 +1953,6 @@ retry2:
 			{
 				if(++dolg >= dolmax)
 					break;
-#if  SHOPT_FILESCAN
-				if(sh.cur_line)
-				{
-					if(!(v=getdolarg(dolg,&vsize)))
-					{
-						dolmax = dolg;
-						break;
-					}
-				}
-				else
-#endif  /* SHOPT_FILESCAN */
 				v = sh.st.dolv[dolg];
 			}
 			else if(!np)
@@ -2139,6 +2089,150 @@ nosub:
 	return 0;
 }
 
+/*
+ * Commands that may be run by a ${ subshare; } within a virtual subshell without forking
+ * first (as long as 'print' is not given -f, as printf formats can assign variables, so
+ * its arguments must all be literal)
+ */
+static const char *subshare_cmds[] = { ":", "echo", "false", "print", "true", NULL };
+
+/*
+ * Check that expanding word <cp> cannot change the shell's state. Only plain
+ * $name and ${name} expansions of variables without disciplines are allowed.
+ */
+static int subshare_word(const char *cp)
+{
+	const char	*name;
+	Namval_t	*np;
+	int		c, brace;
+	while(c = *cp++)
+	{
+		if(c=='`' || c=='~')
+			return 0;
+		if(c!='$')
+			continue;
+		if((brace = *cp=='{'))
+			cp++;
+		if(isdigit(*cp) || !brace && *cp && strchr("@*#?!$-",*cp))
+		{
+			cp++;
+			continue;
+		}
+		name = cp;
+		while(*cp && isaname(*cp))
+			cp++;
+		if(cp==name || brace && *cp++!='}' || *cp=='[')
+			return 0;
+		sfwrite(sh.strbuf,name,cp-name-brace);
+		if((np = nv_search(sfstruse(sh.strbuf),sh.var_tree,0)) && (np->nvfun || nv_isref(np)))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Check redirections the same way. Only file names and duplicating a numbered
+ * file descriptor are allowed; {var}> assigns a variable and here-documents
+ * may expand anything.
+ */
+static int subshare_io(const struct ionod *iop)
+{
+	const char	*cp;
+	for(; iop; iop = iop->ionxt)
+	{
+		if(iop->iofile&(IOVNM|IODOC|IOLSEEK|IOPROCSUB))
+			return 0;
+		if(iop->iofile&IOMOV)
+		{
+			for(cp = iop->ioname; isdigit(*cp); cp++);
+			if(cp==iop->ioname || *cp)
+				return 0;
+		}
+		else if(!subshare_word(iop->ioname))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * A ${ subshare; } shares its state with the parent shell. Within a virtual
+ * subshell, that state would be changed without being saved, so the subshell
+ * is normally forked first. Check if tree <t> can do without that: it may
+ * only consist of simple commands from subshare_cmds[] or external commands,
+ * without assignments, with plain parameter expansions, joined by pipes,
+ * lists, 'if' or '&&'/'||', or run in their own ( subshell ) or background job.
+ */
+static int subshare_safe(const Shnode_t *t)
+{
+	struct argnod	*ap;
+	Pathcomp_t	*pp;
+	Namval_t	*np;
+	const char	*name, *arg;
+	int		i;
+	if(!t)
+		return 1;
+	switch(t->tre.tretyp&COMMSK)
+	{
+	    case TPAR:
+		return 1;
+	    case TFORK:
+		if(t->tre.tretyp&FAMP)
+			return 1;
+		/* FALLTHROUGH */
+	    case TSETIO:
+		return subshare_io(t->fork.forkio) && subshare_safe(t->fork.forktre);
+	    case TFIL:
+	    case TLST:
+	    case TAND:
+	    case TORF:
+		return subshare_safe(t->lst.lstlef) && subshare_safe(t->lst.lstrit);
+	    case TIF:
+		return subshare_safe(t->if_.iftre) && subshare_safe(t->if_.thtre) && subshare_safe(t->if_.eltre);
+	    case TCOM:
+		if(t->com.comset || !subshare_io(t->com.comio))
+			return 0;
+		if(!(t->tre.tretyp&COMSCAN))
+		{
+			if(!t->com.comarg.dp)
+				return 0;
+			name = t->com.comarg.dp->dolval[ARG_SPARE];
+			for(i = ARG_SPARE+1; arg = t->com.comarg.dp->dolval[i]; i++)
+				if(*arg=='-' && strchr(arg,'f') && strcmp(name,"print")==0)
+					return 0;
+		}
+		else
+		{
+			if(!(ap = t->com.comarg.ap) || !(ap->argflag&ARG_RAW))
+				return 0;
+			name = ap->argval;
+			while(ap = ap->argnxt.ap)
+			{
+				if(!(ap->argflag&ARG_RAW) && (strcmp(name,"print")==0 || !subshare_word(ap->argval)))
+					return 0;
+				if(*ap->argval=='-' && strchr(ap->argval,'f') && strcmp(name,"print")==0)
+					return 0;
+			}
+		}
+		if(strchr(name,'/'))
+			return 1;
+		if(np = nv_search(name,sh.fun_tree,0))
+		{
+			if(!is_abuiltin(np))
+				return 0;
+			for(i = 0; subshare_cmds[i]; i++)
+				if(strcmp(name,subshare_cmds[i])==0)
+					return 1;
+			return 0;
+		}
+		/* an external command, unless it is autoloaded from FPATH */
+		for(pp = (Pathcomp_t*)sh.pathlist; pp; pp = pp->next)
+			if(pp->flags&PATH_FPATH)
+				return 0;
+		return 1;
+	}
+	return 0;
+}
+
 /*
  * This routine handles command substitution
  * and arithmetic expansion.
@@ -2161,7 +2255,7 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 	int			was_history = sh_isstate(SH_HISTORY);
 	int			was_verbose = sh_isstate(SH_VERBOSE);
 	int			was_interactive = sh_isstate(SH_INTERACTIVE);
-	int			newlines,bufsize,nextnewlines;
+	int			newlines,bufsize,nextnewlines,line;
 	Sfoff_t			foff;
 	Namval_t		*np;
 	savemac.wasexpan = 1;
@@ -2183,6 +2277,7 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 			else
 				num = sh_arith(sh_mactrim(t->ar.arexpr->argval,3));
 		out_offset:
+			sh_freeup();
 			stkset(stkp,savptr,savtop);
 			*mp = savemac;
 			if((Sflong_t)num!=num)
@@ -2219,11 +2314,11 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 		sh_offstate(SH_VERBOSE);
 		if(mp->sp)
 			sfsync(mp->sp);	/* flush before executing command */
-		sp = sfnew(NULL,str,c,-1,SFIO_STRING|SFIO_READ);
-		c = sh.inlineno;
+		sp = 0;
+		line = sh.inlineno;
 		sh.inlineno = error_info.line+sh.st.firstline;
-		t = (Shnode_t*)sh_parse(sp,SH_EOF|SH_NL);
-		sh.inlineno = c;
+		t = sh_parsestr(str,c,SH_EOF|SH_NL);
+		sh.inlineno = line;
 		type = 1;
 	}
 	if(t)
@@ -2261,8 +2356,13 @@ static void comsubst(Mac_t *mp,Shnode_t* t, int type)
 		}
 		else
 		{
-			if(type==2 && sh.subshell && !sh.subshare)
+			if(type==2 && sh.subshell && !sh.subshare && (sh.st.trap[SH_ERRTRAP] || sh.st.trap[SH_DEBUGTRAP] || !subshare_safe(t)))
+			{
+				sh_stats(STAT_SFSUBSHARE);
 				sh_subfork();	/* subshares within virtual subshells are broken, so fork first */
+			}
+			else if(type==2 && sh.subshell && !sh.subshare)
+				sh_subtracktree(1);	/* keep tracked aliases added by external commands local */
 			sp = sh_subshell(t,sh_isstate(SH_ERREXIT),type);
 		}
 		fcrestore(&save);
@@ -2826,19 +2926,16 @@ static char *special(int c)
 {
 	if(c!='$')
 		nv_setoptimize(NULL);
+#if  SHOPT_FILESCAN
+	if((c=='@' || c=='*' || c=='#') && sh_scanpending())
+		sh_scanargs();
+#endif  /* SHOPT_FILESCAN */
 	switch(c)
 	{
 	    case '@':
 	    case '*':
 		return sh.st.dolc>0?sh.st.dolv[1]:NULL;
 	    case '#':
-#if  SHOPT_FILESCAN
-		if(sh.cur_line)
-		{
-			getdolarg(MAX_ARGN,NULL);
-			return ltos(sh.offsets[0]);
-		}
-#endif  /* SHOPT_FILESCAN */
 		return ltos(sh.st.dolc);
 	    case '!':
 		if(sh.bckpid)
@@ -42,7 +42,7 @@ static Dtdisc_t	_Refdisc =
 };
 
 static void	pushnam(Namval_t*,void*);
-static char	*staknam(Namval_t*, char*);
+static char	*staknam(Stk_t*, Namval_t*, char*);
 static void	rightjust(char*, int, int);
 static char	*lastdot(char*, int);
 
@@ -55,6 +55,7 @@ struct adata
 	Namval_t	*tp;
 	char		*mapname;
 	char		**argnam;
+	Stk_t		*stkp;
 };
 
 /* for a 'typeset -T' type */
@@ -227,7 +228,7 @@ void nv_setlist(struct argnod *arg,int flags, Namval_t *typ)
 	char		*trap=sh.st.trap[SH_DEBUGTRAP];
 	char		*prefix = sh.prefix;
 	int		traceon = (sh_isoption(SH_XTRACE)!=0);
-	int		array = (flags&(NV_ARRAY|NV_IARRAY));
+	int		array = (flags&(NV_ARRAY|NV_IARRAY|NV_AORDER));
 	Namarr_t	*ap;
 	Namval_t	node;
 	struct Namref	nr;
@@ -259,7 +260,7 @@ void nv_setlist(struct argnod *arg,int flags, Namval_t *typ)
 	if(sh.namespace && nv_dict(sh.namespace)==sh.var_tree)
 		flags |= NV_NOSCOPE;
 #endif /* SHOPT_NAMESPACE */
-	flags &= ~(NV_TYPE|NV_ARRAY|NV_IARRAY);
+	flags &= ~(NV_TYPE|NV_ARRAY|NV_IARRAY|NV_AORDER);
 	if(sh.prefix)
 	{
 		flags &= ~(NV_IDENT|NV_EXPORT);
@@ -381,6 +382,8 @@ void nv_setlist(struct argnod *arg,int flags, Namval_t *typ)
 					if(array&NV_ARRAY)
 					{
 						nv_setarray(np,nv_associative);
+						if(array&NV_AORDER)
+							nv_aorder(np);
 						if(typ)
 							nv_settype(np,typ,0);
 					}
@@ -521,17 +524,23 @@ void nv_setlist(struct argnod *arg,int flags, Namval_t *typ)
 					else if(((np->nvalue.cp && np->nvalue.cp!=Empty)||nv_isvtree(np)|| nv_arrayptr(np)) && !nv_type(np))
 					{
 						int was_assoc_array = ap && ap->fun;
+						int was_ordered = was_assoc_array && array_order(ap);
 						_nv_unset(np,NV_EXPORT);  /* this can free ap */
 						if(was_assoc_array)
 							 nv_setarray(np,nv_associative);
+						if(was_ordered)
+							nv_aorder(np);
 					}
 				}
 				else
 				{
+					int was_ordered = (ap=nv_arrayptr(np)) && array_assoc(ap) && array_order(ap);
 					if(!(arg->argflag&ARG_APPEND))
 						_nv_unset(np,NV_EXPORT);
 					if(!(array&NV_IARRAY) && !nv_isarray(np))
 						nv_setarray(np,nv_associative);
+					if(was_ordered || (array&NV_AORDER))
+						nv_aorder(np);
 				}
 			skip:
 				if(sub>0)
@@ -1191,7 +1200,7 @@ Namval_t *nv_create(const char *name,  Dt_t *root, int flags, Namfun_t *dp)
 								ap = nv_arrayptr(np);
 							}
 							if(n && ap && !ap->table)
-								ap->table = dtopen(&_Nvdisc,Dtoset);
+								ap->table = dtopen(&_Nvdisc,Dtopset);
 							if(ap && ap->table && (nq=nv_search(sub,ap->table,n)))
 								nq->nvmeta = np;
 							if(nq && nv_isnull(nq))
@@ -1318,6 +1327,10 @@ void nv_delete(Namval_t* np, Dt_t *root, int flags)
 	}
 	if(root)
 	{
+		Namval_t	*mp;
+		Dt_t		*next;
+		if(nv_isattr(np,NV_EXPORT) || !(flags&NV_TABLE) && (next=dtvnext(root)) && (mp=dtmatch(next,np->nvname)) && nv_isattr(mp,NV_EXPORT))
+			env_change();	/* uncovers an exported variable in an outer scope (table_unset() checks for itself) */
 		if(dtdelete(root,np))
 		{
 			if(!(flags&NV_NOFREE) && ((flags&NV_FUNCTION) || !nv_subsaved(np,flags&NV_TABLE)))
@@ -1641,7 +1654,7 @@ void nv_putval(Namval_t *np, const char *string, int flags)
 	/* Create a local scope when inside of a virtual subshell */
 	nv_setoptimize(NULL);
 	if(sh.subshell && !nv_local && !(flags&NV_RDONLY))
-		sh_assignok(np,1);
+		sh_assignok(np,(flags&(NV_NOREF|NV_NOFREE))?1:2);
 	/* Export the variable if 'set -o allexport' is enabled */
 	if(sh_isoption(SH_ALLEXPORT))
 	{
@@ -2152,16 +2165,18 @@ static void ja_restore(void)
 	savep = 0;
 }
 
-static char *staknam(Namval_t *np, char *value)
+static char *staknam(Stk_t *stkp, Namval_t *np, char *value)
 {
 	char *p,*q;
-	q = stkalloc(sh.stk,strlen(nv_name(np))+(value?strlen(value):0)+2);
+	q = stkalloc(stkp,strlen(nv_name(np))+(value?strlen(value):0)+2);
 	p=strcopy(q,nv_name(np));
 	*p++ = '=';
 	strcpy(p,value);
 	return q;
 }
 
+static char env_volatile;	/* set if an exported value can change without an assignment */
+
 /*
  * Called from sh_envgen() to push an individual variable to export
  */
@@ -2169,28 +2184,33 @@ static void pushnam(Namval_t *np, void *data)
 {
 	char *value;
 	struct adata *ap = (struct adata*)data;
+	Namfun_t *fp;
 	if(strchr(np->nvname,'.'))
 		return;
 	ap->tp = 0;
+	for(fp = np->nvfun; fp; fp = fp->next)
+		if(fp->disc && (fp->disc->getval || fp->disc->getnum))
+			env_volatile = 1;
+	if(nv_isattr(np,NV_DOUBLE)==NV_DOUBLE)
+		env_volatile = 1;	/* radix point depends on the locale */
 	if(value=nv_getval(np))
-		*ap->argnam++ = staknam(np,value);
+		*ap->argnam++ = staknam(ap->stkp,np,value);
 }
 
 /*
- * Generate the environment list for the child.
+ * Build the environment list on stack <stkp>
  */
-char **sh_envgen(void)
+static char **env_build(Stk_t *stkp)
 {
 	char **er;
 	int namec;
 	struct adata data;
 	data.tp = 0;
 	data.mapname = 0;
-	/* L_ARGNOD gets generated automatically as full path name of command */
-	nv_offattr(L_ARGNOD,NV_EXPORT);
+	data.stkp = stkp;
 	namec = nv_scan(sh.var_tree,nullscan,NULL,NV_EXPORT,NV_EXPORT);
 	namec += sh.save_env_n;
-	er = stkalloc(sh.stk,(namec+4)*sizeof(char*));
+	er = stkalloc(stkp,(namec+4)*sizeof(char*));
 	data.argnam = (er+=2) + sh.save_env_n;
 	/* Pass non-imported env vars to child */
 	if(sh.save_env_n)
@@ -2201,6 +2221,46 @@ char **sh_envgen(void)
 	return er;
 }
 
+/*
+ * Generate the environment list for the child.
+ * The list is kept and reused until ast.env_serial is changed by env_change()
+ * or the variable scope changes, so that running a command normally only
+ * copies the pointer array onto the current stack. The strings it points to
+ * remain valid until the next time the list is regenerated.
+ */
+char **sh_envgen(void)
+{
+	static Stk_t	*envstk;
+	static char	**envlist;
+	static uint32_t	envserial;
+	static int	envcount, envbusy;
+	static Dt_t	*envtree;
+	char **er;
+	/* L_ARGNOD gets generated automatically as full path name of command */
+	nv_offattr(L_ARGNOD,NV_EXPORT);
+	if(envbusy)	/* called from a get discipline while generating the list */
+		return env_build(sh.stk);
+	if(!envlist || env_volatile || envserial!=ast.env_serial || envtree!=sh.var_tree)
+	{
+		if(envstk)
+			stkset(envstk,NULL,0);
+		else
+			envstk = stkopen(STK_SMALL);
+		envlist = NULL;
+		env_volatile = 0;
+		envserial = ast.env_serial;
+		envtree = sh.var_tree;
+		envbusy = 1;
+		er = env_build(envstk);
+		envbusy = 0;
+		for(envcount=0; er[envcount]; envcount++);
+		envlist = er;
+	}
+	er = stkalloc(sh.stk,(envcount+3)*sizeof(char*));
+	memcpy(er+=2,envlist,(envcount+1)*sizeof(char*));
+	return er;
+}
+
 struct scan
 {
 	void    (*scanfn)(Namval_t*, void*);
@@ -2286,6 +2346,14 @@ int nv_scan(Dt_t *root, void (*fn)(Namval_t*,void*), void *data,int mask, int fl
 	return sdata.scancount;
 }
 
+/*
+ * Emptied scope dictionaries are kept for reuse, as most function calls
+ * would otherwise open and close one
+ */
+#define SCOPEPOOL	16
+static Dt_t	*scopepool[SCOPEPOOL];
+static int	nscopepool;
+
 /*
  * create a new environment scope
  */
@@ -2297,7 +2365,10 @@ void sh_scope(struct argnod *envlist, int fun)
 	if(sh.namespace)
 		newroot = nv_dict(sh.namespace);
 #endif /* SHOPT_NAMESPACE */
-	newscope = dtopen(&_Nvdisc,Dtoset);
+	if(nscopepool)
+		newscope = scopepool[--nscopepool];
+	else
+		newscope = dtopen(&_Nvdisc,Dtoset);
 	if(envlist)
 	{
 		dtview(newscope,(Dt_t*)sh.var_tree);
@@ -2340,6 +2411,8 @@ static void table_unset(Dt_t *root, int flags, Dt_t *oroot)
 			if(nv_isattr(nq,NV_EXPORT))
 				env_change();
 		}
+		if(nv_isattr(np,NV_EXPORT))
+			env_change();
 		sh.last_root = root;
 		sh.last_table = 0;
 		if(nv_isvtree(np))
@@ -3244,7 +3317,7 @@ int nv_rename(Namval_t *np, int flags)
 		if(ap=nv_arrayptr(np))
 		{
 			if(!ap->table)
-				ap->table = dtopen(&_Nvdisc,Dtoset);
+				ap->table = dtopen(&_Nvdisc,Dtopset);
 			if(ap->table)
 				mp = nv_search(nv_getsub(np),ap->table,NV_ADD);
 			nv_arraychild(np,mp,0);
@@ -3491,7 +3564,10 @@ void sh_unscope(void)
 			sh.st.real_fun->sdict->view = dp;
 		}
 		sh.var_tree=dp;
-		dtclose(root);
+		if(nscopepool < SCOPEPOOL && !root->nview && !dtfirst(root))
+			scopepool[nscopepool++] = root;
+		else
+			dtclose(root);
 	}
 }
 
@@ -987,8 +987,8 @@ int nv_clone(Namval_t *np, Namval_t *mp, int flags)
  */
 Namval_t *nv_search(const char *name, Dt_t *root, int mode)
 {
-	Namval_t *np;
-	Dt_t *dp = 0;
+	Namval_t *np, *mp;
+	Dt_t *dp = 0, *next;
 	/* do not find builtins when using 'command -x' */
 	if(!(mode&NV_ADD) && sh_isstate(SH_XARG) && (root==sh.bltin_tree || root==sh.fun_tree))
 		return NULL;
@@ -996,7 +996,7 @@ Namval_t *nv_search(const char *name, Dt_t *root, int mode)
 		dp = dtview(root,0);
 	if(mode&NV_REF)
 	{
-		Namval_t *mp = (void*)name;
+		mp = (void*)name;
 		if(!(np = dtsearch(root,mp)) && (mode&NV_ADD))
 			name = nv_name(mp);
 	}
@@ -1015,11 +1015,12 @@ Namval_t *nv_search(const char *name, Dt_t *root, int mode)
 			root = nv_dict(sh.namespace);
 		else if(!dp && !(mode&NV_NOSCOPE))
 		{
-			Dt_t *next;
 			while(next=dtvnext(root))
 				root = next;
 		}
 		np = (Namval_t*)dtinstall(root,newnode(name));
+		if((next = dp ? dp : dtvnext(root)) && (mp = dtmatch(next,name)) && nv_isattr(mp,NV_EXPORT))
+			env_change();	/* hides an exported variable in an outer scope */
 	}
 	if(dp)
 		dtview(root,dp);
@@ -1125,6 +1126,8 @@ Namval_t *sh_addbuiltin(const char *path, Shbltin_f bltin, void *extra)
 	char		*cp;
 	Namval_t	*np, *nq=0;
 	int		offset=stktell(sh.stk);
+	if(bltin || extra==(void*)1)
+		sh_parseflush();	/* cached parse trees point to built-in nodes */
 	if(extra==(void*)1)
 		name = path;
 	else if((name = path_basename(path))==path && bltin!=b_typeset && (nq=nv_bfsearch(name,sh.bltin_tree,NULL,&cp)))
@@ -382,6 +382,7 @@ void nv_attribute(Namval_t *np,Sfio_t *out,char *prefix,int noname)
 	char *ip=0;
 	Namfun_t *fp=0; 
 	Namval_t *typep=0;
+	int order=0;
 #if SHOPT_FIXEDARRAY
 	int fixed=0;
 #endif /* SHOPT_FIXEDARRAY */
@@ -459,6 +460,7 @@ void nv_attribute(Namval_t *np,Sfio_t *out,char *prefix,int noname)
 					{
 						if(tp->sh_name[1]!='A')
 							continue;
+						order = array_order(ap);
 					}
 					else if(tp->sh_name[1]=='A')
 						continue;
@@ -487,6 +489,11 @@ void nv_attribute(Namval_t *np,Sfio_t *out,char *prefix,int noname)
 				{
 					if(*tp->sh_name=='-')
 						sfprintf(out,"%.2s ",tp->sh_name);
+					if(order)
+					{
+						sfwrite(out,"-O ",3);
+						order = 0;
+					}
 					if(ip)
 					{
 						sfprintf(out,"'[%s]' ",ip);
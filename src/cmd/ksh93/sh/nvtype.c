@@ -1284,7 +1284,10 @@ int nv_settype(Namval_t* np, Namval_t *tp, int flags)
 		UNREACHABLE();
 	}
 	if(sh.subshell && !sh.subshare)
+	{
+		sh_stats(STAT_SFTYPE);
 		sh_subfork();
+	}
 	if((ap=nv_arrayptr(np)) && ap->nelem>0)
 	{
 		nv_putsub(np,NULL,ARRAY_SCAN);
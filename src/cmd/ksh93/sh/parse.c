@@ -30,6 +30,7 @@
 #include	"defs.h"
 #include	<fcin.h>
 #include	<error.h>
+#include	<hashpart.h>
 #include	"shlex.h"
 #include	"history.h"
 #include	"builtins.h"
@@ -293,7 +294,7 @@ static Shnode_t	*makeparent(Lex_t *lp, int flag, Shnode_t *child)
 	par->fork.forktyp = flag;
 	par->fork.forktre = child;
 	par->fork.forkio = 0;
-	par->fork.forkline = sh_getlineno(lp)-1;
+	par->fork.forkline = sh_getlineno(lp);
 	return par;
 }
 
@@ -458,11 +459,310 @@ void	*sh_parse(Sfio_t *iop, int flag)
 	return t;
 }
 
+/*
+ * Cache of parse trees for command text that is parsed again every time it
+ * is run: `...`, $(...) and ${ ...; } command substitutions, $((...))
+ * arithmetic expansions, eval strings and trap actions. Each tree is compiled
+ * onto a private stack that is kept in a small hash table, keyed on the text,
+ * the line number it starts on, the namespace and the options that influence
+ * the parser. While a cached tree runs, a reference to its stack is put on
+ * sh.st.staklist so that it survives eviction until sh_freeup() is called.
+ * The end of a $(...) is not known until it is parsed, so each prefix of the
+ * input that is as long as some cached $(...) text is hashed and looked up.
+ */
+
+#define PCACHE_MAX	256		/* maximum number of cached trees */
+#define PCACHE_HASH	512		/* number of hash buckets (power of 2) */
+#define PCACHE_TEXT	(16*1024)	/* maximum length of cached text */
+#define PCACHE_AHEAD	2		/* lexer look-ahead past the closing ) */
+
+/* flags, in addition to SH_NL and SH_EOF */
+#define PCACHE_DOLPAREN	004
+#define PCACHE_POSIX	010
+#define PCACHE_BRACE	020
+#define PCACHE_KEYWORD	040
+#define PCACHE_RESTRICT	0100
+#define PCACHE_NOALIAS	0200
+
+struct pcache
+{
+	struct pcache	*next;		/* hash chain */
+	Stk_t		*stak;		/* private stack holding the tree */
+	Shnode_t	*tree;
+	Namval_t	*nspace;	/* namespace at parse time */
+	unsigned int	hash;
+	unsigned int	tick;		/* last use, for eviction */
+	int		line;		/* line number that the text starts on */
+	int		dline;		/* change of sh.inlineno by sh_parse() */
+	int		dfirst;		/* change of sh.st.firstline by sh_parse() */
+	int		flags;
+	size_t		used;		/* number of bytes consumed by the parser */
+	size_t		len;		/* length of text[] */
+	char		text[1];
+};
+
+static struct pcache	*pcache[PCACHE_HASH];
+static int		pcache_count;
+static unsigned int	pcache_tick;
+static unsigned char	pcache_lens[PCACHE_TEXT/CHAR_BIT+1];	/* lengths of $(...) texts */
+
+#define pcache_haslen(n)	(pcache_lens[(n)/CHAR_BIT] & (1<<((n)%CHAR_BIT)))
+
+/*
+ * return the cache key flags for parser flags <flag>, or -1 if the text
+ * must be parsed every time because parsing has side effects
+ */
+static int pcache_flags(Lex_t *lp, int flag)
+{
+	if(sh_isoption(SH_VERBOSE) || sh_isoption(SH_NOEXEC) || sh_isoption(SH_DICTIONARY))
+		return -1;
+	if(sh_isstate(SH_VERBOSE) || sh_isstate(SH_HISTORY) || sh.mktype || sh.shcomp || sh.binscript)
+		return -1;
+#if SHOPT_KIA
+	if(lp->kiafile)
+		return -1;
+#else
+	NOT_USED(lp);
+#endif /* SHOPT_KIA */
+	if(sh_isoption(SH_POSIX))
+		flag |= PCACHE_POSIX;
+	if(sh_isoption(SH_BRACEEXPAND))
+		flag |= PCACHE_BRACE;
+	if(sh_isoption(SH_KEYWORD))
+		flag |= PCACHE_KEYWORD;
+	if(sh_isoption(SH_RESTRICTED))
+		flag |= PCACHE_RESTRICT;
+	if(sh_isstate(SH_NOALIAS))
+		flag |= PCACHE_NOALIAS;
+	return flag;
+}
+
+/*
+ * find the tree for <text> of <len> bytes
+ */
+static struct pcache *pcache_find(const char *text, size_t len, unsigned int hash, int line, int flags)
+{
+	struct pcache *pp;
+	for(pp=pcache[hash&(PCACHE_HASH-1)]; pp; pp=pp->next)
+	{
+		if(pp->hash!=hash || pp->len!=len || pp->line!=line || pp->flags!=flags || pp->nspace!=sh.namespace)
+			continue;
+		if(memcmp(pp->text,text,len)==0)
+		{
+			pp->tick = ++pcache_tick;
+			sh_stats(STAT_PARSEHITS);
+			return pp;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * add a tree to the cache, evicting the least recently used one if full
+ */
+static struct pcache *pcache_add(Stk_t *stak, Shnode_t *t, const char *text, size_t len, size_t used, unsigned int hash, int line, int flags)
+{
+	struct pcache *pp, **ppp, **lru=0;
+	if(pcache_count >= PCACHE_MAX)
+	{
+		int i;
+		for(i=0; i < PCACHE_HASH; i++)
+			for(ppp= &pcache[i]; pp = *ppp; ppp= &pp->next)
+				if(!lru || pp->tick < (*lru)->tick)
+					lru = ppp;
+		pp = *lru;
+		*lru = pp->next;
+		stkclose(pp->stak);
+		free(pp);
+		pcache_count--;
+	}
+	pp = sh_malloc(sizeof(struct pcache)+len);
+	pp->stak = stak;
+	pp->tree = t;
+	pp->nspace = sh.namespace;
+	pp->hash = hash;
+	pp->tick = ++pcache_tick;
+	pp->line = line;
+	pp->dline = pp->dfirst = 0;
+	pp->flags = flags;
+	pp->used = used;
+	pp->len = len;
+	memcpy(pp->text,text,len);
+	ppp = &pcache[hash&(PCACHE_HASH-1)];
+	pp->next = *ppp;
+	*ppp = pp;
+	pcache_count++;
+	if(flags&PCACHE_DOLPAREN)
+		pcache_lens[len/CHAR_BIT] |= 1<<(len%CHAR_BIT);
+	stklink(stak);
+	return pp;
+}
+
+/*
+ * put the reference to <stak> on the list of stacks released by sh_freeup()
+ */
+static void pcache_hold(Stk_t *stak)
+{
+	struct slnod *slp = stkalloc(sh.stk,sizeof(struct slnod));
+	slp->slptr = stak;
+	slp->slchild = 0;
+	slp->slnext = sh.st.staklist;
+	sh.st.staklist = slp;
+}
+
+/*
+ * discard all cached trees; called when aliases or built-ins change
+ */
+void sh_parseflush(void)
+{
+	struct pcache *pp;
+	int i;
+	for(i=0; i < PCACHE_HASH; i++)
+	{
+		while(pp = pcache[i])
+		{
+			pcache[i] = pp->next;
+			stkclose(pp->stak);
+			free(pp);
+		}
+	}
+	pcache_count = 0;
+	memset(pcache_lens,0,sizeof(pcache_lens));
+}
+
+static Shnode_t *dolparen(Lex_t*);
+
+/*
+ * parse from <iop>, or up to the matching ) if <iop> is NULL, onto a new stack
+ */
+static Shnode_t *pcache_parse(Lex_t *lp, Sfio_t *iop, int flag, Stk_t **stakp)
+{
+	Shnode_t	*volatile t = 0;
+	Stk_t		*savstak = sh.stk;
+	struct checkpt	buff;
+	int		jmpval;
+	sh.stk = stkopen(STK_SMALL);
+	sh_pushcontext(&buff,1);
+	jmpval = sigsetjmp(buff.buff,0);
+	if(jmpval==0)
+		t = iop ? (Shnode_t*)sh_parse(iop,flag) : dolparen(lp);
+	sh_popcontext(&buff);
+	*stakp = sh.stk;
+	sh.stk = savstak;
+	if(jmpval)
+	{
+		stkclose(*stakp);
+		siglongjmp(*sh.jmplist,jmpval);
+	}
+	return t;
+}
+
+/*
+ * parse the complete string <str> of <len> bytes using the parse tree cache
+ * <flag> is passed on to sh_parse()
+ */
+Shnode_t *sh_parsestr(char *str, size_t len, int flag)
+{
+	Lex_t		*lp = (Lex_t*)sh.lex_context;
+	Shnode_t	*t;
+	Sfio_t		*iop;
+	Stk_t		*stak;
+	struct pcache	*pp;
+	unsigned int	hash;
+	int		line, flags = pcache_flags(lp,flag);
+	int		inlineno = sh.inlineno, firstline = sh.st.firstline;
+	if(flags<0 || len>PCACHE_TEXT || *str==CNTL('k'))
+	{
+		iop = sfnew(NULL,str,len,-1,SFIO_STRING|SFIO_READ);
+		t = (Shnode_t*)sh_parse(iop,flag);
+		sfclose(iop);
+		return t;
+	}
+	line = sh.inlineno;
+	if((flag&SH_NL) && (line=error_info.line+sh.st.firstline)==0)
+		line = 1;
+	hash = memhash(str,len) + line;
+	sh.st.staklist = 0;
+	if(pp = pcache_find(str,len,hash,line,flags))
+	{
+		if(flag&SH_NL)
+		{
+			/* leave the line numbers as sh_parse() would */
+			lp->inlineno = inlineno;
+			lp->firstline = firstline;
+			sh.inlineno = inlineno + pp->dline;
+			sh.st.firstline = firstline + pp->dfirst;
+		}
+		stklink(pp->stak);
+		pcache_hold(pp->stak);
+		return pp->tree;
+	}
+	sh_stats(STAT_PARSEMISS);
+	iop = sfnew(NULL,str,len,-1,SFIO_STRING|SFIO_READ);
+	t = pcache_parse(lp,iop,flag,&stak);
+	sfclose(iop);
+	/* trees that define functions own further stacks and are not cached */
+	if(t && !sh.st.staklist)
+	{
+		pp = pcache_add(stak,t,str,len,len,hash,line,flags);
+		pp->dline = sh.inlineno - inlineno;
+		pp->dfirst = sh.st.firstline - firstline;
+	}
+	pcache_hold(stak);
+	return t;
+}
+
 /*
  * This routine parses up the matching right parenthesis and returns
- * the parse tree
+ * the parse tree, using the parse tree cache if the input is a string
  */
 Shnode_t *sh_dolparen(Lex_t* lp)
+{
+	Shnode_t	*t;
+	Stk_t		*stak;
+	struct pcache	*pp;
+	char		*cp, *buff;
+	size_t		len, used;
+	unsigned int	hash;
+	int		line, flags;
+	if(fcfile() || (flags = pcache_flags(lp,PCACHE_DOLPAREN))<0)
+		return dolparen(lp);
+	cp = fcseek(0);
+	line = error_info.line+sh.st.firstline;
+	for(hash=0, len=0; len<PCACHE_TEXT && cp[len]; )
+	{
+		HASHPART(hash,((unsigned char*)cp)[len]);
+		len++;
+		if(pcache_haslen(len) && (pp = pcache_find(cp,len,hash+line,line,flags)))
+		{
+			fcseek(pp->used);
+			stklink(pp->stak);
+			pcache_hold(pp->stak);
+			return pp->tree;
+		}
+	}
+	if(cp[len])
+		return dolparen(lp);
+	sh_stats(STAT_PARSEMISS);
+	buff = fcfirst();
+	t = pcache_parse(lp,NULL,0,&stak);
+	/* an alias expansion may have converted the string to a file */
+	used = fcseek(0) - cp;
+	if(t && !sh.st.staklist && fcfirst()==buff && used<=len)
+	{
+		if(used+PCACHE_AHEAD < len)
+			len = used+PCACHE_AHEAD;
+		pcache_add(stak,t,cp,len,used,memhash(cp,len)+line,line,flags);
+	}
+	pcache_hold(stak);
+	return t;
+}
+
+/*
+ * This routine parses up the matching right parenthesis and returns
+ * the parse tree
+ */
+static Shnode_t *dolparen(Lex_t* lp)
 {
 	Shnode_t *t=0;
 	Sfio_t *sp = fcfile();
@@ -33,6 +33,12 @@
 #include	"jobs.h"
 #include	"history.h"
 #include	"test.h"
+#include	"shnodes.h"
+#include	"version.h"
+#include	<tmx.h>
+#if SHOPT_PATHCACHE
+#include	<ast_dir.h>
+#endif
 #include	"FEATURE/dynamic"
 
 #define RW_ALL	(S_IRUSR|S_IRGRP|S_IROTH|S_IWUSR|S_IWGRP|S_IWOTH)
@@ -75,13 +81,16 @@ static int ondefpath(const char *name)
 	return 0;
 }
 
-static pid_t _spawnveg(const char *path, char* const argv[], char* const envp[], pid_t pgid)
+/*
+ * spawn is encoded as for path_spawn(); a background job does not get the terminal
+ */
+static pid_t _spawnveg(const char *path, char* const argv[], char* const envp[], int spawn)
 {
 	pid_t pid;
 	while(1)
 	{
 		sh_stats(STAT_SPAWN);
-		pid = spawnveg(path,argv,envp,pgid,job.jobcontrol?job.fd:-1);
+		pid = spawnveg(path,argv,envp,spawn>>3,(job.jobcontrol && !(spawn&4))?job.fd:-1);
 		if(pid>=0 || errno!=EAGAIN)
 			break;
 	}
@@ -101,7 +110,7 @@ static pid_t _spawnveg(const char *path, char* const argv[], char* const envp[],
 static unsigned arg_extra = _arg_extrabytes;
 /*
  * used with command -x to run the command in multiple passes
- * spawn is non-zero when invoked via spawn
+ * spawn is non-zero when invoked via spawn; it is encoded as for path_spawn()
  * the exitval is set to the maximum for each execution
  */
 static pid_t command_xargs(const char *path, char *argv[],char *const envp[], int spawn)
@@ -186,7 +195,7 @@ static pid_t command_xargs(const char *path, char *argv[],char *const envp[], in
 		else if(spawn)
 		{
 			sh.xargexit = exitval;
-			return _spawnveg(path,argv,envp,spawn>>1);
+			return _spawnveg(path,argv,envp,spawn);
 		}
 		else
 			return execve(path,argv,envp);
@@ -523,6 +532,108 @@ char *path_fullname(const char *name)
 	return path;
 }
 
+/*
+ * Compiled script cache. If the exported variable SHCOMP_CACHE names a
+ * directory, the parse trees of dot scripts and FPATH function files are
+ * saved there in shcomp(1) format the first time they are run, and later
+ * read from there (memory mapped by sfio where possible) instead of being
+ * parsed again. A cache file is named after the shell version and the
+ * device and inode of the script. It starts with a header that repeats
+ * these along with the posix and keyword options and the size and
+ * modification time of the script; a cache file with an outdated header is
+ * replaced. A script is not cached if parsing it expanded an alias.
+ */
+
+struct Scriptcache
+{
+	Sfio_t	*out;		/* compiled parse trees are written here */
+	int	fd;
+	int	failed;
+	char	*tmpname;	/* renamed to name when complete */
+	char	*name;
+};
+
+#define CNTL(x)	((x)&037)
+static const char cache_hdr[6] = { CNTL('k'),CNTL('s'),CNTL('h'),0,SHCOMP_HDR_VERSION,0 };
+
+/*
+ * return a stream for running script <fd> with sh_eval(), using buffer
+ * <buff> of IOBSIZE bytes if the script is read as text
+ */
+Sfio_t *path_cacheopen(int fd, char *buff)
+{
+	struct Scriptcache	*cp;
+	struct stat		st, cst;
+	char			*dir = sh_getenv("SHCOMP_CACHE");
+	char			hdr[PATH_MAX], chk[PATH_MAX];
+	char			*name;
+	int			cfd, n;
+	if(!dir || *dir!='/' || sh_isoption(SH_RESTRICTED) || sh_isoption(SH_PRIVILEGED) || sh.scriptcache
+	|| fstat(fd,&st) < 0 || !S_ISREG(st.st_mode))
+		return sfnew(NULL,buff,IOBSIZE,fd,SFIO_READ);
+	n = sfsprintf(hdr,sizeof(hdr),"%s\n%d %d %llu %llu %lld %lld\n",e_version,sh_isoption(SH_POSIX)!=0,sh_isoption(SH_KEYWORD)!=0,(Sfulong_t)st.st_dev,(Sfulong_t)st.st_ino,(Sflong_t)st.st_size,(Sflong_t)tmxgetmtime(&st));
+	sfprintf(sh.strbuf,"%s/%08x-%llx-%llx",dir,strhash(e_version),(Sfulong_t)st.st_dev,(Sfulong_t)st.st_ino);
+	name = sfstruse(sh.strbuf);
+	if((cfd = open(name,O_RDONLY)) >= 0)
+	{
+		/* only trust a cache file that nobody else could have written */
+		if(fstat(cfd,&cst) >= 0 && S_ISREG(cst.st_mode) && cst.st_uid==geteuid() && !(cst.st_mode&(S_IWGRP|S_IWOTH))
+		&& read(cfd,chk,n)==n && memcmp(chk,hdr,n)==0 && dup2(cfd,fd)==fd)
+		{
+			close(cfd);
+			fcntl(fd,F_SETFD,FD_CLOEXEC);
+			return sfnew(NULL,NULL,(size_t)SFIO_UNBOUND,fd,SFIO_READ);
+		}
+		close(cfd);
+	}
+	cp = sh_newof(0,struct Scriptcache,1,2*strlen(name)+16);
+	cp->name = (char*)(cp+1);
+	cp->tmpname = strcopy(cp->name,name)+1;
+	sfsprintf(cp->tmpname,strlen(name)+15,"%s.%d",name,(int)sh.current_pid);
+	if((cp->fd = sh_open(cp->tmpname,O_WRONLY|O_CREAT|O_EXCL,0644)) < 0)
+	{
+		free(cp);
+		return sfnew(NULL,buff,IOBSIZE,fd,SFIO_READ);
+	}
+	if((cp->fd = sh_iomovefd(cp->fd)) > 0)
+	{
+		fcntl(cp->fd,F_SETFD,FD_CLOEXEC);
+		sh.fdstatus[cp->fd] |= IOCLEX;
+	}
+	cp->out = sfnew(NULL,NULL,(size_t)SFIO_UNBOUND,cp->fd,SFIO_WRITE);
+	if(sfwrite(cp->out,hdr,n)!=n || sfwrite(cp->out,cache_hdr,sizeof(cache_hdr))!=sizeof(cache_hdr))
+		cp->failed = 1;
+	sh.scriptcache = cp;
+	return sfnew(NULL,buff,IOBSIZE,fd,SFIO_READ);
+}
+
+/*
+ * add parse tree <t> to the compiled script being written
+ */
+void path_cachetree(void *ptr, Shnode_t *t)
+{
+	struct Scriptcache *cp = (struct Scriptcache*)ptr;
+	if(t && !cp->failed && sh_tdump(cp->out,t) < 0)
+		cp->failed = 1;
+}
+
+/*
+ * finish writing the compiled script; it is only kept if <complete>
+ */
+void path_cacheclose(void *ptr, int complete)
+{
+	struct Scriptcache *cp = (struct Scriptcache*)ptr;
+	if(sfsync(cp->out) < 0)
+		cp->failed = 1;
+	sfsetfd(cp->out,-1);
+	sfclose(cp->out);
+	if(sh_close(cp->fd) < 0)
+		cp->failed = 1;
+	if(!complete || cp->failed || rename(cp->tmpname,cp->name) < 0)
+		unlink(cp->tmpname);
+	free(cp);
+}
+
 /*
  * load functions from file <fno>
  */
@@ -574,7 +685,7 @@ static void funload(int fno, const char *name)
 	sh.funload = 1;
 	sh.inlineno = 1;
 	error_info.line = 0;
-	sh_eval(sfnew(NULL,buff,IOBSIZE,fno,SFIO_READ),SH_FUNEVAL);
+	sh_eval(path_cacheopen(fno,buff),SH_FUNEVAL);
 	sh_close(fno);
 	sh.readscript = 0;
 #if SHOPT_NAMESPACE
@@ -692,6 +803,184 @@ int	path_search(const char *name,Pathcomp_t **oldpp, int flag)
 	return 0;
 }
 
+#if SHOPT_PATHCACHE
+/*
+ * Cache of the file names in the absolute directories in $PATH and $FPATH,
+ * so that a command search does not have to stat(2) a file in each of them.
+ * A directory is read in one pass and read again when its modification or
+ * status change time changes. These are checked at most once per
+ * PATHCACHE_TTL, and whenever sh.pathgen changed since, i.e., when the shell
+ * or a child process may have created a file, so that a command newly added
+ * to a directory earlier in $PATH is found before one of the same name later
+ * in $PATH. A directory modified less than PATHCACHE_TTL ago is not cached.
+ * A directory on a file system that finds names other than those listed,
+ * e.g. ignoring case, is not cached.
+ */
+
+#define PATHCACHE_TTL	((Time_t)1000000000)	/* nanoseconds */
+#define PATHCACHE_MAX	64			/* directories */
+
+typedef struct Pathdir
+{
+	struct Pathdir	*next;
+	Time_t		mtime;		/* modification time when read */
+	Time_t		ctime;		/* status change time when read */
+	Time_t		checked;	/* last time mtime was checked */
+	unsigned int	gen;		/* sh.pathgen at that time */
+	int		inexact;	/* names are not matched exactly; not cached */
+	dev_t		dev;
+	ino_t		ino;
+	unsigned int	mask;		/* hash table size - 1 */
+	unsigned int	*table;		/* offset+1 into names; 0 if empty */
+	char		*names;
+	char		dir[1];
+} Pathdir_t;
+
+static Pathdir_t	*pathdirs;
+static int		npathdirs;
+
+/*
+ * Returns 1 if the file system of directory <dp> finds the listed file <name>
+ * under another case, 0 if not, or -1 if <name> has no letters
+ */
+static int dircache_inexact(Pathdir_t *dp, const char *name)
+{
+	char		path[PATH_MAX], *cp;
+	struct stat	st, cst;
+	int		c, n, changed = 0;
+	if((n = sfsprintf(path,sizeof(path),"%s/%s",dp->dir,name)) >= sizeof(path)-1)
+		return 0;
+	for(cp = path+n-strlen(name); c = *cp; cp++)
+	{
+		if(isupper(c))
+			*cp = tolower(c), changed = 1;
+		else if(islower(c))
+			*cp = toupper(c), changed = 1;
+	}
+	if(!changed)
+		return -1;
+	if(stat(path,&cst) < 0)
+		return 0;
+	strcpy(path+n-strlen(name),name);
+	return stat(path,&st)>=0 && cst.st_ino==st.st_ino && cst.st_dev==st.st_dev;
+}
+
+/*
+ * (re)read directory <dp> whose stat(2) data is <st>
+ * returns 0 if the directory cannot be read
+ */
+static int dircache_read(Pathdir_t *dp, struct stat *st)
+{
+	DIR		*dirp;
+	struct dirent	*ep;
+	char		*names = 0;
+	size_t		size = 0, used = 0, n;
+	unsigned int	count = 0, mask, h, *table;
+	free(dp->table);
+	free(dp->names);
+	dp->table = 0;
+	dp->names = 0;
+	if(!(dirp = opendir(dp->dir)))
+		return 0;
+	while(ep = readdir(dirp))
+	{
+		if(ep->d_name[0]=='.' && (!ep->d_name[1] || ep->d_name[1]=='.' && !ep->d_name[2]))
+			continue;
+		n = strlen(ep->d_name) + 1;
+		if(used + n > size)
+		{
+			size = roundof(used + n, 4096) * 2;
+			names = sh_realloc(names,size);
+		}
+		memcpy(names+used,ep->d_name,n);
+		used += n;
+		count++;
+	}
+	closedir(dirp);
+	/* one name with letters tells if the file system ignores case */
+	for(n=0; n < used && (dp->inexact = dircache_inexact(dp,names+n)) < 0; n += strlen(names+n)+1);
+	if(dp->inexact > 0)
+	{
+		free(names);
+		return 0;
+	}
+	dp->inexact = 0;
+	for(mask=15; mask < 2*count; mask = 2*mask+1);
+	table = sh_newof(0,unsigned int,mask+1,0);
+	for(n=0; n < used; n += strlen(names+n)+1)
+	{
+		for(h=strhash(names+n)&mask; table[h]; h=(h+1)&mask);
+		table[h] = n + 1;
+	}
+	dp->table = table;
+	dp->names = names;
+	dp->mask = mask;
+	dp->mtime = tmxgetmtime(st);
+	dp->ctime = tmxgetctime(st);
+	dp->dev = st->st_dev;
+	dp->ino = st->st_ino;
+	return 1;
+}
+
+/*
+ * Returns 0 if <name> is known not to exist in directory <pp>, 1 otherwise
+ */
+static int dircache_has(Pathcomp_t *pp, const char *name)
+{
+	Pathdir_t	*dp = pp->dircache;
+	struct stat	st;
+	Time_t		now;
+	unsigned int	h, off;
+	if(*pp->name!='/' || strchr(name,'/'))
+		return 1;
+	if(!dp)
+	{
+		for(dp=pathdirs; dp; dp=dp->next)
+			if(strcmp(dp->dir,pp->name)==0)
+				break;
+		if(!dp)
+		{
+			if(npathdirs >= PATHCACHE_MAX)
+				return 1;
+			dp = sh_newof(0,Pathdir_t,1,strlen(pp->name));
+			strcpy(dp->dir,pp->name);
+			dp->next = pathdirs;
+			pathdirs = dp;
+			npathdirs++;
+		}
+		pp->dircache = dp;
+	}
+	if(dp->inexact)
+		return 1;
+	now = tmxgettime();
+	if(!dp->table || now - dp->checked >= PATHCACHE_TTL || dp->gen!=sh.pathgen)
+	{
+		dp->checked = now;
+		dp->gen = sh.pathgen;
+		if(stat(dp->dir,&st) < 0 || !S_ISDIR(st.st_mode))
+			return 1;
+		if(now - tmxgetmtime(&st) < PATHCACHE_TTL)
+		{
+			/* recently modified: it may change again within the same time stamp */
+			free(dp->table);
+			dp->table = 0;
+			return 1;
+		}
+		if(!dp->table || tmxgetmtime(&st)!=dp->mtime || tmxgetctime(&st)!=dp->ctime || st.st_ino!=dp->ino || st.st_dev!=dp->dev)
+		{
+			if(!dircache_read(dp,&st))
+				return 1;
+		}
+	}
+	if(!dp->table)
+		return 1;
+	for(h=strhash(name)&dp->mask; off=dp->table[h]; h=(h+1)&dp->mask)
+		if(strcmp(dp->names+off-1,name)==0)
+			return 1;
+	return 0;
+}
+#endif /* SHOPT_PATHCACHE */
+
 /*
  * do a path search and find the full pathname of file name
  *
@@ -809,8 +1098,18 @@ Pathcomp_t *path_absolute(const char *name, Pathcomp_t *pp, int flag)
 #endif /* SHOPT_DYNAMIC */
 		}
 		sh.bltin_dir = 0;
-		sh_stats(STAT_PATHS);
-		f = canexecute(stkptr(sh.stk,PATH_OFFSET),isfun);
+#if SHOPT_PATHCACHE
+		if(!dircache_has(oldpp,name))
+		{
+			f = -1;
+			errno = ENOENT;
+		}
+		else
+#endif /* SHOPT_PATHCACHE */
+		{
+			sh_stats(STAT_PATHS);
+			f = canexecute(stkptr(sh.stk,PATH_OFFSET),isfun);
+		}
 		if(isfun && f>=0 && (cp = strrchr(name,'.')))
 		{
 			*cp = 0;
@@ -1020,6 +1319,11 @@ noreturn void path_exec(const char *arg0,char *argv[],struct argnod *local)
 	}
 }
 
+/*
+ * Execute, or with nonzero <spawn>, spawn the command <opath>. <spawn> is encoded as
+ * (pgid<<3) | 4 for a background job | 2 if the caller forks itself on ENOEXEC | 1,
+ * where pgid is passed on to spawnveg(3).
+ */
 pid_t path_spawn(const char *opath,char **argv, char **envp, Pathcomp_t *libpath, int spawn)
 {
 	char		*path;
@@ -1169,7 +1473,7 @@ pid_t path_spawn(const char *opath,char **argv, char **envp, Pathcomp_t *libpath
 	else
 #endif
 	if(spawn)
-		pid = _spawnveg(opath, &argv[0], envp, spawn>>1);
+		pid = _spawnveg(opath, &argv[0], envp, spawn);
 	else
 		pid = execve(opath, &argv[0], envp);
 	if(xp)
@@ -1194,7 +1498,8 @@ pid_t path_spawn(const char *opath,char **argv, char **envp, Pathcomp_t *libpath
 		 */
 		if(spawn)
 		{
-			if(sh.subshell)
+			/* with spawn&2, the caller forks itself (and closes pipe ends the child must not have) */
+			if(sh.subshell || (spawn&2))
 				return -1;
 			do
 			{
@@ -1316,12 +1621,16 @@ static noreturn void exscript(char *path,char *argv[],char **envp)
 	{
 		static Stk_t	*envstk;
 		Stk_t		*savstk = sh.stk;
+		char		**ep;
 		if (envstk)
 			stkset(envstk, NULL, 0);
 		else
 			envstk = stkopen(STK_SMALL);
 		sh.stk = envstk;
 		environ = sh_envgen();
+		/* the strings are shared with the cached list, which may be regenerated */
+		for(ep = environ; *ep; ep++)
+			*ep = stkcopy(envstk,*ep);
 		sh.stk = savstk;
 		stkfreeze(envstk,0);
 	}
@@ -0,0 +1,296 @@
+/***********************************************************************
+*                                                                      *
+*              This file is part of the ksh 93u+m package              *
+*            Copyright (c) 2026 Contributors to ksh 93u+m              *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*                                                                      *
+***********************************************************************/
+/*
+ * Script profiler for the .sh.profile variable
+ *
+ * Assigning a file name to .sh.profile starts profiling. Each time a command,
+ * arithmetic command, [[ test, 'for' or 'case' begins, the wall clock and CPU
+ * time elapsed since the previous one is charged to the previous one's call
+ * stack and line number. Unsetting or emptying .sh.profile, or exiting the
+ * shell, writes the totals in microseconds in the "collapsed stack" format
+ * read by flame graph tools, one line per stack:
+ *
+ *	script;func1;func2;file:line microseconds
+ *
+ * Scripts and files are identified by their base names.
+ *
+ * Wall clock time goes to the named file and CPU time (user plus system, of
+ * the shell and of waited-for child processes) goes to the same name with
+ * .cpu appended.
+ */
+
+#include	"shopt.h"
+#include	"defs.h"
+#include	"variables.h"
+#include	"path.h"
+#include	"io.h"
+#include	"FEATURE/time"
+
+#if SHOPT_STATS
+
+#if _lib_getrusage && !defined(RUSAGE_SELF)
+#   include <sys/resource.h>
+#endif
+
+typedef struct Profent
+{
+	Dtlink_t	link;
+	Sfulong_t	wall;		/* wall clock microseconds */
+	Sfulong_t	cpu;		/* CPU microseconds */
+	char		key[1];		/* collapsed stack; allocated to size */
+} Profent_t;
+
+struct Profile
+{
+	Namfun_t	hdr;
+	char		*file;		/* absolute path of output file */
+	pid_t		pid;		/* process that is profiling */
+	Dt_t		*dict;		/* Profent_t entries by stack */
+	Profent_t	*last;		/* entry being charged */
+	Sfulong_t	wall;		/* time stamps of the last event */
+	Sfulong_t	cpu;
+	char		**frames;	/* function or dot script names by depth */
+	int		nframes;
+	unsigned int	gen;		/* incremented when a frame changes */
+	unsigned int	lastgen;	/* these five identify the last event */
+	int		lastline;
+	int		lastdepth;
+	char		*lastfile;
+	Sfio_t		*key;
+};
+
+static Dtdisc_t	profdisc =
+{
+	offsetof(Profent_t,key), 0, offsetof(Profent_t,link)
+};
+
+static void prof_times(Sfulong_t *wall, Sfulong_t *cpu)
+{
+	struct timeval	tv;
+#if _lib_getrusage
+	struct rusage	self, child;
+	getrusage(RUSAGE_SELF, &self);
+	getrusage(RUSAGE_CHILDREN, &child);
+	*cpu = (Sfulong_t)self.ru_utime.tv_sec*1000000 + self.ru_utime.tv_usec
+	     + (Sfulong_t)self.ru_stime.tv_sec*1000000 + self.ru_stime.tv_usec
+	     + (Sfulong_t)child.ru_utime.tv_sec*1000000 + child.ru_utime.tv_usec
+	     + (Sfulong_t)child.ru_stime.tv_sec*1000000 + child.ru_stime.tv_usec;
+#else
+	struct tms	tms;
+	times(&tms);
+	*cpu = (Sfulong_t)(tms.tms_utime + tms.tms_stime + tms.tms_cutime + tms.tms_cstime) * 1000000 / sh.lim.clk_tck;
+#endif /* _lib_getrusage */
+	timeofday(&tv);
+	*wall = (Sfulong_t)tv.tv_sec*1000000 + tv.tv_usec;
+}
+
+/*
+ * Charge the time since the last event to the last entry and reset the time stamps
+ */
+static void prof_charge(struct Profile *pp)
+{
+	Sfulong_t	wall, cpu;
+	prof_times(&wall, &cpu);
+	if(pp->last)
+	{
+		pp->last->wall += wall - pp->wall;
+		pp->last->cpu += cpu - pp->cpu;
+	}
+	pp->wall = wall;
+	pp->cpu = cpu;
+}
+
+/*
+ * Called before each command while profiling
+ */
+void sh_proftick(int line)
+{
+	struct Profile	*pp = sh.profile;
+	Profent_t	*ep;
+	char		*file, *key;
+	int		depth = sh.fn_depth + sh.dot_depth, i;
+	if(pp->pid != sh.current_pid)
+	{
+		/* forked subshell: the parent writes the profile */
+		sh.profile = NULL;
+		return;
+	}
+	prof_charge(pp);
+	file = sh.st.filename ? path_basename(sh.st.filename) : pp->frames[0];
+	if(pp->last && line==pp->lastline && depth==pp->lastdepth && file==pp->lastfile && pp->gen==pp->lastgen)
+		return;
+	for(i=0; i<=depth; i++)
+	{
+		char *cp = i < pp->nframes && pp->frames[i] ? pp->frames[i] : "?";
+		sfputr(pp->key,cp,';');
+	}
+	sfprintf(pp->key,"%s:%d",file,line);
+	key = sfstruse(pp->key);
+	if(!(ep = dtmatch(pp->dict,key)))
+	{
+		size_t n = strlen(key);
+		ep = sh_newof(0,Profent_t,1,n);
+		memcpy(ep->key,key,n+1);
+		dtinsert(pp->dict,ep);
+	}
+	pp->last = ep;
+	pp->lastline = line;
+	pp->lastdepth = depth;
+	pp->lastfile = file;
+	pp->lastgen = pp->gen;
+}
+
+/*
+ * Set the name of the frame at <depth>
+ */
+static void prof_frame(struct Profile *pp, int depth, const char *name)
+{
+	if(depth >= pp->nframes)
+	{
+		int n = pp->nframes;
+		pp->nframes = depth + 16;
+		pp->frames = sh_newof(pp->frames,char*,pp->nframes,n);
+	}
+	if(!name)
+		name = "?";
+	else if(*name=='/')
+		name = path_basename(name);
+	if(pp->frames[depth] && strcmp(pp->frames[depth],name)==0)
+		return;
+	free(pp->frames[depth]);
+	pp->frames[depth] = sh_strdup(name);
+	pp->gen++;
+}
+
+/*
+ * Called on entering a function or dot script while profiling
+ */
+void sh_profenter(const char *name)
+{
+	prof_frame(sh.profile, sh.fn_depth + sh.dot_depth, name);
+}
+
+static void prof_write(struct Profile *pp, const char *suffix, int cpu)
+{
+	Sfio_t		*out;
+	Profent_t	*ep;
+	char		*file = pp->file;
+	if(suffix)
+	{
+		sfprintf(sh.strbuf,"%s%s",file,suffix);
+		file = sfstruse(sh.strbuf);
+	}
+	if(!(out = sfopen(NULL,file,"w")))
+	{
+		errormsg(SH_DICT,ERROR_warn(0),e_create,file);
+		return;
+	}
+	for(ep = dtfirst(pp->dict); ep; ep = dtnext(pp->dict,ep))
+	{
+		Sfulong_t n = cpu ? ep->cpu : ep->wall;
+		if(n)
+			sfprintf(out,"%s %llu\n",ep->key,n);
+	}
+	sfclose(out);
+}
+
+/*
+ * Stop profiling and write the results
+ */
+static void prof_stop(void)
+{
+	struct Profile	*pp = sh.profile;
+	Profent_t	*ep;
+	int		i;
+	sh.profile = NULL;
+	if(pp->pid != sh.current_pid)
+		return;
+	prof_charge(pp);
+	prof_write(pp,NULL,0);
+	prof_write(pp,".cpu",1);
+	while(ep = dtfirst(pp->dict))
+	{
+		dtdelete(pp->dict,ep);
+		free(ep);
+	}
+	dtclose(pp->dict);
+	sfclose(pp->key);
+	for(i=0; i < pp->nframes; i++)
+		free(pp->frames[i]);
+	free(pp->frames);
+	free(pp->file);
+	pp->dict = NULL;
+	pp->key = NULL;
+	pp->frames = NULL;
+	pp->nframes = 0;
+	pp->file = NULL;
+}
+
+static void prof_start(struct Profile *pp, const char *file)
+{
+	int	depth = sh.fn_depth + sh.dot_depth;
+	pp->file = path_fullname(file);
+	pp->pid = sh.current_pid;
+	pp->dict = dtopen(&profdisc,Dtoset);
+	pp->key = sfstropen();
+	pp->last = NULL;
+	pp->gen = 0;
+	sh.profile = pp;
+	prof_frame(pp,0,path_basename(sh.st.self==&sh.global && sh.st.filename ? sh.st.filename : sh.shname));
+	/* functions already running when profiling starts are not known */
+	while(depth > 0)
+		prof_frame(pp,depth--,NULL);
+	prof_times(&pp->wall,&pp->cpu);
+}
+
+static void put_profile(Namval_t *np, const char *val, int flags, Namfun_t *fp)
+{
+	char	*cp;
+	if(sh.profile)
+		prof_stop();
+	if(!val)
+	{
+		/* keep the discipline across unset */
+		fp = nv_stack(np, NULL);
+		nv_putv(np, val, flags, fp);
+		fp->next = np->nvfun;
+		np->nvfun = fp;
+		return;
+	}
+	nv_putv(np, val, flags, fp);
+	if((cp = nv_getval(np)) && *cp)
+		prof_start((struct Profile*)fp,cp);
+}
+
+static const Namdisc_t PROFILE_disc = { sizeof(struct Profile), put_profile };
+
+void sh_profinit(void)
+{
+	struct Profile *pp = sh_newof(0,struct Profile,1,0);
+	pp->hdr.disc = &PROFILE_disc;
+	pp->hdr.nofree = 1;
+	nv_stack(SH_PROFILENOD, &pp->hdr);
+}
+
+/*
+ * Called on exit from the shell
+ */
+void sh_profdone(void)
+{
+	if(sh.profile)
+		prof_stop();
+}
+
+#endif /* SHOPT_STATS */
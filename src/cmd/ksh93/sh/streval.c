@@ -42,6 +42,7 @@
 
 #define MAXLEVEL	1024
 #define SMALL_STACK	12
+#define MAXFOLD		16	/* maximum run of integer literals tracked for constant folding */
 
 /*
  * The following are used with tokenbits() macro
@@ -70,7 +71,11 @@ struct vars				/* vars stacked per invocation */
 	int		stakmaxsize;	/* maximum stack size needed	*/
 	unsigned char	paren;	 	/* parenthesis level		*/
 	char		infun;	/* incremented by comma inside function	*/
+	char		nointcode;	/* set if code needs Sfdouble_t arithmetic */
 	int		emode;
+	int		nilit;		/* number of integer literals in ilit */
+	int		ilit[MAXFOLD];	/* offsets of a run of A_PUSHI instructions */
+	int		ilitend;	/* code offset just past the last A_PUSHI */
 	Sfdouble_t	(*convert)(const char**,struct lval*,int,Sfdouble_t);
 };
 
@@ -144,6 +149,87 @@ static Sfdouble_t U2F(Sfulong_t u)
 #define U2F(x)		x
 #endif
 
+/*
+ * Apply integer operator <op> to <a> and <b> (just <b> if unary), storing the result in *<rp>.
+ * Returns 0 if the result would overflow or be undefined, or <op> needs Sfdouble_t arithmetic.
+ */
+static int intop(int op, Sflong_t a, Sflong_t b, Sflong_t *rp)
+{
+	switch(op)
+	{
+	    case A_NOT:
+		*rp = !b;
+		return 1;
+	    case A_TILDE:
+		*rp = ~b;
+		return 1;
+	    case A_UMINUS:
+		if(b==INTMAX_MIN)
+			return 0;
+		*rp = -b;
+		return 1;
+	    case A_PLUS:
+		if(b>0 ? a>INTMAX_MAX-b : a<INTMAX_MIN-b)
+			return 0;
+		*rp = a+b;
+		return 1;
+	    case A_MINUS:
+		if(b<0 ? a>INTMAX_MAX+b : a<INTMAX_MIN+b)
+			return 0;
+		*rp = a-b;
+		return 1;
+	    case A_TIMES:
+		if(a>0 ? (b>0 ? a>INTMAX_MAX/b : b<INTMAX_MIN/a) : (b>0 ? a<INTMAX_MIN/b : a && b<INTMAX_MAX/a))
+			return 0;
+		*rp = a*b;
+		return 1;
+	    case A_DIV:
+		if(b==0 || (b==-1 && a==INTMAX_MIN))
+			return 0;
+		*rp = a/b;
+		return 1;
+	    case A_MOD:
+		if(b==0)
+			return 0;
+		*rp = b==-1 ? 0 : a%b;
+		return 1;
+	    case A_LSHIFT:
+	    case A_RSHIFT:
+		if(b<0 || b>=8*sizeof(Sflong_t))
+			return 0;
+		*rp = op==A_LSHIFT ? a<<b : a>>b;
+		return 1;
+	    case A_XOR:
+		*rp = a^b;
+		return 1;
+	    case A_OR:
+		*rp = a|b;
+		return 1;
+	    case A_AND:
+		*rp = a&b;
+		return 1;
+	    case A_EQ:
+		*rp = a==b;
+		return 1;
+	    case A_NEQ:
+		*rp = a!=b;
+		return 1;
+	    case A_LE:
+		*rp = a<=b;
+		return 1;
+	    case A_GE:
+		*rp = a>=b;
+		return 1;
+	    case A_GT:
+		*rp = a>b;
+		return 1;
+	    case A_LT:
+		*rp = a<b;
+		return 1;
+	}
+	return 0;
+}
+
 Sfdouble_t	arith_exec(Arith_t *ep)
 {
 	Sfdouble_t	num=0,*dp,*sp;
@@ -156,6 +242,8 @@ Sfdouble_t	arith_exec(Arith_t *ep)
 	int		lastsub=0;
 	Math_f		fun;
 	struct lval	node;
+	Sflong_t	inum=0,*isp,*ibp,small_istack[SMALL_STACK+1];
+	unsigned char	*ip;
 	node.emode = ep->emode;
 	node.expr = ep->expr;
 	node.elen = ep->elen;
@@ -175,6 +263,129 @@ Sfdouble_t	arith_exec(Arith_t *ep)
 		sp = stkalloc(sh.stk,ep->staksize*(sizeof(Sfdouble_t)+1));
 	tp = (char*)(sp+ep->staksize);
 	tp--,sp--;
+	if(ep->intcode)
+	{
+		/*
+		 * Integer fast path: as long as all values are integer literals or values of integer
+		 * variables and nothing overflows, use Sflong_t arithmetic. Anything else is left to
+		 * the Sfdouble_t code below, which resumes from the instruction at <ip>.
+		 */
+		if(ep->staksize < SMALL_STACK)
+			ibp = small_istack;
+		else
+			ibp = stkalloc(sh.stk,ep->staksize*sizeof(Sflong_t));
+		isp = ibp-1;
+		while(c = *(ip=cp++))
+		{
+			switch(c&T_OP)
+			{
+			    case A_JMP: case A_JMPZ: case A_JMPNZ:
+				c &= T_OP;
+				cp = roundptr(ep,cp,short);
+				if((c==A_JMPZ && inum) || (c==A_JMPNZ && !inum))
+					cp += sizeof(short);
+				else
+					cp = (unsigned char*)ep + *((short*)cp);
+				continue;
+			    case A_NOTNOT:
+				inum = (inum!=0);
+				break;
+			    case A_PLUSPLUS: case A_MINUSMINUS:
+			    case A_INCR: case A_DECR:
+				if(!intop(((c&T_OP)==A_PLUSPLUS || (c&T_OP)==A_INCR) ? A_PLUS : A_MINUS, inum, 1, &node.ival))
+					goto spill;
+				node.nosub = -1;
+				if(!(*ep->fun)(&ptr,&node,INTASSIGN,0))
+					goto spill;
+				if((c&T_OP)==A_INCR || (c&T_OP)==A_DECR)
+					inum = node.ival;
+				break;
+			    case A_SWAP:
+				inum = isp[-1];
+				isp[-1] = *isp;
+				break;
+			    case A_POP:
+				isp--;
+				continue;
+			    case A_ASSIGNOP1:
+			    case A_PUSHV:
+				cp = roundptr(ep,cp,Sfdouble_t*);
+				dp = *((Sfdouble_t**)cp);
+				cp += sizeof(Sfdouble_t*);
+				if(*(short*)cp)
+					goto spill;
+				cp += sizeof(short);
+				node.value = (char*)dp;
+				node.flag = 0;
+				node.isfloat = 0;
+				node.level = sh.arithrecursion;
+				node.nosub = 0;
+				if(!(*ep->fun)(&ptr,&node,INTVALUE,0))
+					goto spill;
+				if((c&T_OP)==A_ASSIGNOP1)
+					lastsub = 0;
+				lastval = (char*)dp;
+				*++isp = inum = node.ival;
+				c = 0;
+				break;
+			    case A_ENUM:
+				node.eflag = 1;
+				continue;
+			    case A_ASSIGNOP:
+			    case A_STORE:
+				cp = roundptr(ep,cp,Sfdouble_t*);
+				dp = *((Sfdouble_t**)cp);
+				cp += sizeof(Sfdouble_t*);
+				if(*(short*)cp > 0)
+					goto spill;
+				cp += sizeof(short);
+				if((c&T_OP)==A_ASSIGNOP)
+					node.nosub = lastsub;
+				node.value = (char*)dp;
+				node.flag = 0;
+				if(lastval)
+					node.eflag = 1;
+				node.ptr = 0;
+				node.ival = inum;
+				if(!(*ep->fun)(&ptr,&node,INTASSIGN,0))
+					goto spill;
+				inum = node.ival;
+				lastval = 0;
+				c = 0;
+				break;
+			    case A_PUSHI:
+				cp = roundptr(ep,cp,Sflong_t);
+				*++isp = inum = *((Sflong_t*)cp);
+				cp += sizeof(Sflong_t);
+				break;
+			    default:
+				if(!intop(c&T_OP,(c&T_BINARY)?isp[-1]:0,inum,&inum))
+					goto spill;
+				break;
+			}
+			if(c)
+				lastval = 0;
+			if(c&T_BINARY)
+			{
+				node.ptr = 0;
+				isp--;
+			}
+			*isp = inum;
+		}
+		if(sh.arithrecursion>0)
+			sh.arithrecursion--;
+		return inum;
+	spill:
+		/* copy the integer stack and redo the instruction that could not be done */
+		for(; ibp <= isp; ibp++)
+		{
+			*++sp = *ibp;
+			*++tp = 0;
+		}
+		num = inum;
+		type = 0;
+		cp = ip;
+	}
 	while(c = *cp++)
 	{
 		if(c&T_NOFLOAT)
@@ -315,6 +526,13 @@ Sfdouble_t	arith_exec(Arith_t *ep)
 			*++sp = num;
 			*++tp = type = *cp++;
 			break;
+		    case A_PUSHI:
+			cp = roundptr(ep,cp,Sflong_t);
+			num = *((Sflong_t*)cp);
+			cp += sizeof(Sflong_t);
+			*++sp = num;
+			*++tp = type = 0;
+			break;
 		    case A_NOT:
 			type=0;
 			num = !num;
@@ -561,6 +779,40 @@ static int gettok(struct vars *vp)
 /*   
  * evaluate a subexpression with precedence
  */
+/*
+ * push integer literal <n>, remembering where it is for constant folding
+ */
+static void pushint(struct vars *vp, Sflong_t n)
+{
+	int offset = stktell(sh.stk);
+	if(offset!=vp->ilitend || vp->nilit>=MAXFOLD)
+		vp->nilit = 0;
+	vp->ilit[vp->nilit++] = offset;
+	sfputc(sh.stk,A_PUSHI);
+	vp->ilitend = stkpush(sh.stk,vp,n,Sflong_t) + sizeof(Sflong_t);
+}
+
+/*
+ * if the operand(s) of <op> are the integer literal(s) just pushed,
+ * replace them by the result and return 1
+ */
+static int foldint(struct vars *vp, int op)
+{
+	int		n = (op&T_BINARY) ? 2 : 1;
+	Sflong_t	a=0, b, r;
+	if(vp->nilit<n || vp->ilitend!=stktell(sh.stk))
+		return 0;
+	b = *(Sflong_t*)stkptr(sh.stk,vp->ilitend-sizeof(Sflong_t));
+	if(n==2)
+		a = *(Sflong_t*)stkptr(sh.stk,vp->ilit[vp->nilit-1]-sizeof(Sflong_t));
+	if(!intop(op&T_OP,a,b,&r))
+		return 0;
+	vp->nilit -= n;
+	stkseek(sh.stk,vp->ilit[vp->nilit]);
+	pushint(vp,r);
+	return 1;
+}
+
 static int expr(struct vars *vp,int precedence)
 {
 	int		c, op;
@@ -602,7 +854,8 @@ again:
 	    common:
 		if(!expr(vp,c))
 			return 0;
-		sfputc(sh.stk,op);
+		if(c==A_LVALUE || !foldint(vp,op))
+			sfputc(sh.stk,op);
 		break;
 	    default:
 		vp->nextchr = vp->errchr;
@@ -716,6 +969,7 @@ again:
 					userfun = T_BINARY;
 				else if((int)lvalue.nargs&040)
 					userfun = T_NOFLOAT;
+				vp->nointcode = 1;
 				sfputc(sh.stk,A_PUSHF);
 				stkpush(sh.stk,vp,fun,Math_f);
 				sfputc(sh.stk,1);
@@ -783,6 +1037,7 @@ again:
 			if(!expr(vp,3))
 				return 0;
 			*((short*)stkptr(sh.stk,offset2)) = stktell(sh.stk);
+			vp->nilit = 0;
 			lvalue.value = 0;
 			wasop = 0;
 			break;
@@ -807,6 +1062,7 @@ again:
 			if(!expr(vp,c))
 				return 0;
 			*((short*)stkptr(sh.stk,offset)) = stktell(sh.stk);
+			vp->nilit = 0;
 			if(op!=A_QCOLON)
 				sfputc(sh.stk,A_NOTNOT);
 			lvalue.value = 0;
@@ -820,6 +1076,13 @@ again:
 		case A_PLUS:	case A_MINUS:	case A_TIMES:	case A_DIV:
 		case A_EQ:	case A_NEQ:	case A_LT:	case A_LE:
 		case A_GT:	case A_GE:	case A_POW:
+			if(op==A_POW)
+				vp->nointcode = 1;
+			else if(foldint(vp,op|T_BINARY))
+			{
+				vp->staksize--;
+				break;
+			}
 			sfputc(sh.stk,op|T_BINARY);
 			vp->staksize--;
 			break;
@@ -861,11 +1124,17 @@ again:
 			}
 			if(op==A_DIG || op==A_LIT)
 			{
-				sfputc(sh.stk,A_PUSHN);
 				if(vp->staksize++>=vp->stakmaxsize)
 					vp->stakmaxsize = vp->staksize;
-				stkpush(sh.stk,vp,d,Sfdouble_t);
-				sfputc(sh.stk,lvalue.isfloat);
+				if(!lvalue.isfloat && d>=LDBL_LLONG_MIN && d< -LDBL_LLONG_MIN && (Sflong_t)d==d)
+					pushint(vp,(Sflong_t)d);
+				else
+				{
+					vp->nointcode = 1;
+					sfputc(sh.stk,A_PUSHN);
+					stkpush(sh.stk,vp,d,Sfdouble_t);
+					sfputc(sh.stk,lvalue.isfloat);
+				}
 			}
 			/* check for function call */
 			if(lvalue.fun)
@@ -923,6 +1192,7 @@ Arith_t *arith_compile(const char *string,char **last,Sfdouble_t(*fun)(const cha
 	ep->emode = emode;
 	ep->size = offset - sizeof(Arith_t);
 	ep->staksize = cur.stakmaxsize+1;
+	ep->intcode = !cur.nointcode;
 	if(last)
 		*last = (char*)(cur.nextchr);
 	return ep;
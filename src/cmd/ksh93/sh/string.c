@@ -686,6 +686,56 @@ int sh_strchr(const char *string, const char *dp)
 	return cp ? cp-string : -1;
 }
 
+/*
+ * Match <string> against the shell pattern <pat> without the regex engine
+ * if <pat> is literal or its only special characters are a leading and/or
+ * trailing '*'. Returns 1 for a match, 0 for no match, or -1 if <pat> must
+ * be matched by strmatch(3) or strgrpmatch(3) instead.
+ */
+int sh_simplematch(const char *string, const char *pat)
+{
+	const char *cp;
+	size_t n, m;
+	int star = 0;
+	for(cp = pat; *cp; cp++)
+	{
+		switch(*cp)
+		{
+		    case '*':
+			if(cp==pat)
+				star |= 1;
+			else if(cp[1]==0)
+				star |= 2;
+			else
+				return -1;
+			break;
+		    case '?': case '[': case '\\': case '(': case ')': case '|': case '&':
+			return -1;
+		}
+	}
+	if(!star)
+		return strcmp(string,pat)==0;
+	/* a byte string match is only a character match in single-byte and UTF-8 locales */
+	if(mbwide() && !(lcinfo(LC_CTYPE)->lc->flags&LC_utf8))
+		return -1;
+	n = cp - pat - (star&1) - ((star&2)>>1);
+	pat += star&1;
+	switch(star)
+	{
+	    case 1:
+		return (m = strlen(string)) >= n && memcmp(string+m-n,pat,n)==0;
+	    case 2:
+		return strncmp(string,pat,n)==0;
+	    default:
+		if(n==0)
+			return 1;
+		for(cp = string; cp = strchr(cp,*pat); cp++)
+			if(strncmp(cp,pat,n)==0)
+				return 1;
+		return 0;
+	}
+}
+
 const char *_sh_translate(const char *message)
 {
 	return ERROR_translate(0,0,e_dict,message);
@@ -34,10 +34,7 @@
 #include	"jobs.h"
 #include	"variables.h"
 #include	"path.h"
-
-#ifndef PIPE_BUF
-#   define PIPE_BUF	512
-#endif
+#include	"ulimit.h"
 
 #ifndef O_SEARCH
 #   ifdef O_PATH
@@ -47,18 +44,62 @@
 #   endif
 #endif
 
+#ifndef SHOPT_COMSUBMEM
+#   define SHOPT_COMSUBMEM	(1024*1024)
+#endif
+
 /*
- * Note that the following structure must be the same
- * size as the Dtlink_t structure
+ * A node changed in a virtual subshell. The copy of the node's old state
+ * starts at <dict>; <dict> and <node> take the place of its Dtlink_t.
  */
 struct Link
 {
+	Dtlink_t	hash;	/* in the subshell's dictionary of saved nodes */
 	struct Link	*next;
+	struct Savelem	*elem;	/* saved elements of an indexed array */
+	char		saved;	/* the copy of the node is valid */
 	Namval_t	*child;
 	Dt_t		*dict;
 	Namval_t	*node;
 };
 
+#define LINKSIZE	(offsetof(struct Link,dict)+sizeof(Namval_t))
+
+/*
+ * An element of an indexed array changed in a virtual subshell. Saving only
+ * the elements that are changed avoids copying the whole array.
+ */
+typedef struct Savelem
+{
+	Dtlink_t	hash;	/* in the subshell's dictionary of saved elements */
+	Namval_t	*node;	/* the array (first half of the key) */
+	long		index;	/* the element (second half of the key) */
+	struct Savelem	*next;	/* next saved element of the same array */
+	char		*val;	/* old value, or NULL if the element was unset */
+} Savelem_t;
+
+static Dtdisc_t svardisc =
+{
+	offsetof(struct Link,node), sizeof(Namval_t*), offsetof(struct Link,hash)
+};
+
+static Dtdisc_t selemdisc =
+{
+	offsetof(Savelem_t,node), sizeof(Namval_t*)+sizeof(long), offsetof(Savelem_t,hash)
+};
+
+#if _lib_getrlimit
+/*
+ * A resource limit as it was before 'ulimit' changed it in a virtual subshell
+ */
+struct Limit
+{
+	struct Limit	*next;
+	int		res;
+	struct rlimit	rl;
+};
+#endif /* _lib_getrlimit */
+
 /*
  * The following structure is used for command substitution and (...)
  */
@@ -67,6 +108,8 @@ static struct subshell
 	struct subshell	*prev;	/* previous subshell data */
 	struct subshell	*pipe;	/* subshell where output goes to pipe on fork */
 	struct Link	*svar;	/* save shell variable table */
+	Dt_t		*svardict; /* the same, by node */
+	Dt_t		*selemdict; /* saved array elements, by node and index */
 	Dt_t		*sfun;	/* function scope for subshell */
 	Dt_t		*strack;/* tracked alias scope for subshell */
 	Pathcomp_t	*pathlist; /* for PATH variable */
@@ -76,6 +119,9 @@ static struct subshell
 	char		*pwd;	/* present working directory */
 	void		*jobs;	/* save job info */
 	mode_t		mask;	/* saved umask */
+#if _lib_getrlimit
+	struct Limit	*limits; /* saved resource limits */
+#endif /* _lib_getrlimit */
 	int		tmpfd;	/* saved tmp file descriptor */
 	int		pipefd;	/* read fd if pipe is created */
 	char		jobcontrol;
@@ -104,15 +150,18 @@ static unsigned int subenv;
 
 
 /*
- * This routine will turn the sftmp() file into a real temporary file
+ * This routine will turn the sftmp() file into a real temporary file on file descriptor 1.
+ * If the output grew too large for memory, sftmp() already made a temporary file, but
+ * on another file descriptor.
  */
 void	sh_subtmpfile(void)
 {
-	if(sfset(sfstdout,0,0)&SFIO_STRING)
+	int string = sfset(sfstdout,0,0)&SFIO_STRING;
+	int fd;
+	struct subshell *sp = subshell_data->pipe;
+	if(string || sp && (fd = sffileno(sfstdout)) >= 0 && fd != 1)
 	{
-		int fd;
 		struct checkpt	*pp = (struct checkpt*)sh.jmplist;
-		struct subshell *sp = subshell_data->pipe;
 		/* save file descriptor 1 if open */
 		if((sp->tmpfd = fd = sh_fcntl(1,F_DUPFD,10)) >= 0)
 		{
@@ -126,7 +175,8 @@ void	sh_subtmpfile(void)
 			UNREACHABLE();
 		}
 		/* popping a discipline forces a /tmp file create */
-		sfdisc(sfstdout,SFIO_POPDISC);
+		if(string)
+			sfdisc(sfstdout,SFIO_POPDISC);
 		if((fd=sffileno(sfstdout))<0)
 		{
 			errormsg(SH_DICT,ERROR_SYSTEM|ERROR_PANIC,"could not create temp file");
@@ -163,6 +213,7 @@ void sh_subfork(void)
 	char comsub = sh.comsub;
 	pid_t pid;
 	char *trap = sh.st.trapcom[0];
+	sh_stats(STAT_SUBFORKS);
 	if(trap)
 		trap = sh_strdup(trap);
 	/* see whether inside $(...) */
@@ -201,28 +252,59 @@ void sh_subfork(void)
 	}
 }
 
+#if _lib_getrlimit
+/*
+ * Called by 'ulimit' in a virtual subshell before it changes the soft limit of
+ * resource <n> from <rp>. The old limit is saved for sh_subshell() to restore.
+ */
+void sh_sublimit(int n, struct rlimit *rp)
+{
+	struct subshell	*sp = subshell_data;
+	struct Limit	*lp;
+	for(lp = sp->limits; lp; lp = lp->next)
+		if(lp->res==n)
+			return;
+	lp = sh_newof(0,struct Limit,1,0);
+	lp->res = n;
+	lp->rl = *rp;
+	lp->next = sp->limits;
+	sp->limits = lp;
+}
+#endif /* _lib_getrlimit */
+
+/*
+ * free a saved node and its saved array elements
+ */
+static void link_free(struct subshell *sp, struct Link *lp)
+{
+	Savelem_t	*ep, *epnext;
+	dtdelete(sp->svardict,lp);
+	for(ep=lp->elem; ep; ep=epnext)
+	{
+		epnext = ep->next;
+		dtdelete(sp->selemdict,ep);
+		free(ep->val);
+		free(ep);
+	}
+	free(lp);
+}
+
 int nv_subsaved(Namval_t *np, int flags)
 {
 	struct subshell	*sp;
-	struct Link		*lp, *lpprev;
+	struct Link		*lp, **lpp;
 	for(sp = (struct subshell*)subshell_data; sp; sp=sp->prev)
 	{
-		lpprev = 0;
-		for(lp=sp->svar; lp; lpprev=lp, lp=lp->next)
+		if(sp->svardict && (lp = (struct Link*)dtmatch(sp->svardict,&np)))
 		{
-			if(lp->node==np)
+			if(flags&NV_TABLE)
 			{
-				if(flags&NV_TABLE)
-				{
-					if(lpprev)
-						lpprev->next = lp->next;
-					else
-						sp->svar = lp->next;
-					free(np);
-					free(lp);
-				}
-				return 1;
+				for(lpp = &sp->svar; *lpp!=lp; lpp = &(*lpp)->next);
+				*lpp = lp->next;
+				link_free(sp,lp);
+				free(np);
 			}
+			return 1;
 		}
 	}
 	return 0;
@@ -246,6 +328,21 @@ void sh_save_rand_seed(struct rand *rp, int reseed)
 		sh_reseed_rand(rp);
 }
 
+/*
+ * Return the index of the current element of array <np> if it can be saved
+ * and restored on its own, or -1 if the whole array must be saved
+ */
+static long elemindex(Namval_t *np, Namarr_t *ap)
+{
+	if(!ap || array_assoc(ap) || ap->fixed || ap->scope || (ap->nelem&(ARRAY_TREE|ARRAY_SCAN|ARRAY_UNDEF)))
+		return -1;
+	if(np->nvfun!=&ap->hdr || ap->hdr.next || nv_isattr(np,~(NV_ARRAY|NV_NOFREE|NV_MINIMAL|NV_EXPORT)))
+		return -1;
+	if(sh_isoption(SH_ALLEXPORT) && !nv_isattr(np,NV_EXPORT))
+		return -1;
+	return nv_aindex(np);
+}
+
 /*
  * This routine will make a copy of the given node in the
  * layer created by the most recent virtual subshell if the
@@ -253,6 +350,8 @@ void sh_save_rand_seed(struct rand *rp, int reseed)
  *
  * add == 0:    Move the node pointer from the parent shell to the current virtual subshell.
  * add == 1:    Create a copy of the node pointer in the current virtual subshell.
+ * add == 2:    Like 1, but only the value of the current array element will change,
+ *		so for a plain indexed array, only that element needs to be saved.
  */
 void sh_assignok(Namval_t *np,int add)
 {
@@ -263,6 +362,7 @@ void sh_assignok(Namval_t *np,int add)
 	Namval_t		*mpnext;
 	Namarr_t		*ap;
 	unsigned int		save;
+	long			index;
 	/*
 	 * Don't create a scope if told not to (see nv_restore()) or if this is a subshare.
 	 * Also, ${.sh.level} (SH_LEVELNOD) is handled specially and is not scoped in virtual subshells.
@@ -275,16 +375,45 @@ void sh_assignok(Namval_t *np,int add)
 		sh_assignok(mp,add);
 		if(!add || array_assoc(ap))
 			return;
+		add = 1;	/* the element is a node of its own */
 	}
-	for(lp=sp->svar; lp;lp = lp->next)
+	if(!sp->svardict)
 	{
-		if(lp->node==np)
+		sp->svardict = dtopen(&svardisc,Dtset);
+		sp->selemdict = dtopen(&selemdisc,Dtset);
+	}
+	if((lp = (struct Link*)dtmatch(sp->svardict,&np)) && lp->saved)
+		return;
+	if(!lp)
+	{
+		lp = (struct Link*)sh_newof(0,char,LINKSIZE,0);
+		lp->node = np;
+		lp->next = sp->svar;
+		sp->svar = lp;
+		dtinsert(sp->svardict,lp);
+	}
+	if(add==2 && (index = elemindex(np,ap)) >= 0)
+	{
+		Savelem_t	*ep, key;
+		char		*cp;
+		memset(&key,0,sizeof(key));
+		key.node = np;
+		key.index = index;
+		if(dtmatch(sp->selemdict,&key.node))
 			return;
+		ep = sh_newof(0,Savelem_t,1,0);
+		ep->node = np;
+		ep->index = index;
+		if(cp = nv_getval(np))
+			ep->val = sh_strdup(cp);
+		ep->next = lp->elem;
+		lp->elem = ep;
+		dtinsert(sp->selemdict,ep);
+		return;
 	}
-	/* first two pointers use linkage from np */
-	lp = (struct Link*)sh_malloc(sizeof(*np)+2*sizeof(void*));
-	memset(lp,0, sizeof(*mp)+2*sizeof(void*));
-	lp->node = np;
+	lp->saved = 1;
+	if(!add && ap && !array_assoc(ap) && !nv_isvtree(np))
+		add = 1;	/* moving an indexed array would leave nothing to change in the subshell */
 	if(!add &&  nv_isvtree(np))
 	{
 		Namval_t	fake;
@@ -307,8 +436,6 @@ void sh_assignok(Namval_t *np,int add)
 	}
 	lp->dict = dp;
 	mp = (Namval_t*)&lp->dict;
-	lp->next = subshell_data->svar; 
-	subshell_data->svar = lp;
 	save = sh.subshell;
 	sh.subshell = 0;
 	mp->nvname = np->nvname;
@@ -324,6 +451,7 @@ void sh_assignok(Namval_t *np,int add)
 static void nv_restore(struct subshell *sp)
 {
 	struct Link	*lp, *lq;
+	Savelem_t	*ep;
 	Namval_t	*mp, *np;
 	Namval_t	*mpnext;
 	int		flags,nofree;
@@ -335,6 +463,8 @@ static void nv_restore(struct subshell *sp)
 		mp = lp->node;
 		if(!mp->nvname)
 			continue;
+		if(!lp->saved)
+			goto elements;
 		flags = 0;
 		if(nv_isattr(mp,NV_MINIMAL) && !nv_isattr(np,NV_EXPORT))
 			flags |= NV_MINIMAL;
@@ -382,9 +512,26 @@ static void nv_restore(struct subshell *sp)
 			mpnext = *((Namval_t**)mp);
 			dtinsert(lp->dict,mp);
 		}
-		free(lp);
+	elements:
+		/* elements were saved before any copy of the whole array, so restore them last */
+		for(ep=lp->elem; ep; ep=ep->next)
+		{
+			mp = lp->node;
+			nv_putsub(mp,NULL,ep->index|ARRAY_ADD);
+			if(ep->val)
+				nv_putval(mp,ep->val,NV_RDONLY);
+			else
+				_nv_unset(mp,NV_RDONLY);
+		}
+		link_free(sp,lp);
 		sp->svar = lq;
 	}
+	if(sp->svardict)
+	{
+		dtclose(sp->svardict);
+		dtclose(sp->selemdict);
+		sp->svardict = sp->selemdict = NULL;
+	}
 	subshell_noscope = 0;
 }
 
@@ -605,8 +752,8 @@ Sfio_t *sh_subshell(Shnode_t *t, volatile int flags, int comsub)
 			sp->fdstatus = sh.fdstatus[1];
 			sp->tmpfd = -1;
 			sp->pipefd = -1;
-			/* use sftmp() file for standard output */
-			if(!(iop = sftmp(PIPE_BUF)))
+			/* use sftmp() file for standard output; keep up to SHOPT_COMSUBMEM bytes in memory */
+			if(!(iop = sftmp(SHOPT_COMSUBMEM)))
 			{
 				sfswap(sp->saveout,sfstdout);
 				errormsg(SH_DICT,ERROR_system(1),e_tmpcreate);
@@ -627,7 +774,10 @@ Sfio_t *sh_subshell(Shnode_t *t, volatile int flags, int comsub)
 			sh.savesig = 0;
 #if _lib_fchdir
 			if(sp->pwdfd < 0 && !sh.subshare)	/* if we couldn't get a file descriptor to our PWD ... */
+			{
+				sh_stats(STAT_SFCD);
 				sh_subfork();			/* ...we have to fork, as we cannot fchdir back to it. */
+			}
 #else
 			if(!sh.subshare)
 			{
@@ -637,7 +787,10 @@ Sfio_t *sh_subshell(Shnode_t *t, volatile int flags, int comsub)
 					sp->pwd = NULL;
 				}
 				if(!sp->pwd)
+				{
+					sh_stats(STAT_SFCD);
 					sh_subfork();
+				}
 			}
 #endif /* _lib_fchdir */
 			/* Virtual subshells are not safe to suspend (^Z, SIGTSTP) in the interactive main shell. */
@@ -648,7 +801,10 @@ Sfio_t *sh_subshell(Shnode_t *t, volatile int flags, int comsub)
 				if(comsub)
 					sigblock(SIGTSTP);
 				else
+				{
+					sh_stats(STAT_SFSIGNAL);
 					sh_subfork();
+				}
 			}
 			sh_offstate(SH_PROFILE);
 			sh_exec(t,flags);
@@ -844,6 +1000,15 @@ Sfio_t *sh_subshell(Shnode_t *t, volatile int flags, int comsub)
 #endif /* _lib_fchdir */
 		if(sp->mask!=sh.mask)
 			umask(sh.mask=sp->mask);
+#if _lib_getrlimit
+		while(sp->limits)
+		{
+			struct Limit *lp = sp->limits;
+			setrlimit(lp->res,&lp->rl);
+			sp->limits = lp->next;
+			free(lp);
+		}
+#endif /* _lib_getrlimit */
 		if(sh.coutpipe!=sp->coutpipe)
 		{
 			sh_close(sh.coutpipe);
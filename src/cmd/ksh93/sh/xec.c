@@ -57,7 +57,8 @@
     extern int	nice(int);
 #endif /* _lib_nice */
 #if SHOPT_SPAWN
-    static pid_t sh_ntfork(const Shnode_t*,char*[],int*,int);
+    static pid_t sh_ntfork(const Shnode_t*,char*[],int*,int,int);
+    static char **ntfork_args(const Shnode_t*,int);
 #endif /* SHOPT_SPAWN */
 
 static void	sh_funct(Namval_t*, int, char*[], struct argnod*,int);
@@ -610,14 +611,18 @@ int sh_eval(Sfio_t *iop, int mode)
 {
 	Shnode_t *t;
 	struct slnod *saveslp = sh.st.staklist;
+	char *cp;
 	int jmpval;
 	struct checkpt *pp = (struct checkpt*)sh.jmplist;
 	struct checkpt *buffp = stkalloc(sh.stk,sizeof(struct checkpt));
 	static Sfio_t *io_save;
 	volatile int traceon=0, lineno=0;
+	unsigned int aliasexp;
 	int binscript=sh.binscript;
 	char comsub = sh.comsub;
+	void *volatile cache = sh.scriptcache;
 	io_save = iop; /* preserve correct value across longjmp */
+	sh.scriptcache = 0;
 	sh.binscript = 0;
 	sh.comsub = 0;
 	sh_pushcontext(buffp,SH_JMPEVAL);
@@ -631,20 +636,39 @@ int sh_eval(Sfio_t *iop, int mode)
 			if(traceon=sh_isoption(SH_XTRACE))
 				sh_offoption(SH_XTRACE);
 		}
+		aliasexp = sh.aliasexp;
 		/* Read and parse the entire script into one node before executing */
-		t = (Shnode_t*)sh_parse(iop,(mode&(SH_READEVAL|SH_FUNEVAL))?mode&SH_FUNEVAL:SH_NL);
+		if(!(mode&(SH_READEVAL|SH_FUNEVAL)) && (sfset(iop,0,0)&SFIO_STRING) && !sfdisc(iop,(Sfdisc_t*)iop)
+		&& (cp = sfreserve(iop,SFIO_UNBOUND,0)))
+			t = sh_parsestr(cp,sfvalue(iop),SH_NL);	/* eval string or trap action: use parse tree cache */
+		else
+			t = (Shnode_t*)sh_parse(iop,(mode&(SH_READEVAL|SH_FUNEVAL))?mode&SH_FUNEVAL:SH_NL);
 		if(errno && sferror(iop))
 		{
 			/* Error reading, presumably from dot script file */
 			errormsg(SH_DICT,ERROR_system(1),e_readscript);
 			UNREACHABLE();
 		}
+		if(cache && sh.aliasexp!=aliasexp)
+		{
+			/* the parse tree depends on the aliases: do not cache it */
+			path_cacheclose(cache,0);
+			cache = 0;
+		}
+		if(cache)
+			path_cachetree(cache,t);
 		if(!(mode&SH_FUNEVAL) || !sfreserve(iop,0,0))
 		{
 			if(!(mode&SH_READEVAL))
 				sfclose(iop);
 			io_save = 0;
 			mode &= ~SH_FUNEVAL;
+			if(cache)
+			{
+				/* whole script parsed: keep the compiled script */
+				path_cacheclose(cache,1);
+				cache = 0;
+			}
 		}
 		mode &= ~SH_READEVAL;
 		if(!sh_isoption(SH_VERBOSE))
@@ -659,6 +683,8 @@ int sh_eval(Sfio_t *iop, int mode)
 			break;
 	}
 	sh_popcontext(buffp);
+	if(cache)
+		path_cacheclose(cache,0);
 	sh.binscript = binscript;
 	sh.comsub = comsub;
 	if(traceon)
@@ -780,11 +806,24 @@ static void unset_instance(Namval_t *nq, Namval_t *node, struct Namref *nr,long
 	while(close(0)<0 && errno==EINTR)
 		errno = err;
 	open(e_devnull,O_RDONLY);
-	sh.offsets[0] = -1;
-	sh.offsets[1] = 0;
 	*save = savein;
 	return sp;
     }
+
+    /*
+     * restore the positional parameters if the fields of a line replaced them
+     */
+    static void scanreset(struct Filescan *fp)
+    {
+	if(fp->argv && sh.st.dolv >= fp->argv && sh.st.dolv < fp->argv+fp->argmax)
+	{
+		sh.st.dolv = fp->dolv;
+		sh.st.dolc = fp->dolc;
+	}
+	fp->dolv = NULL;
+	sh_argfree(fp->dolh,0);
+	fp->dolh = NULL;
+    }
 #endif /* SHOPT_FILESCAN */
 
 #if SHOPT_NAMESPACE
@@ -946,6 +985,7 @@ int sh_exec(const Shnode_t *t, int flags)
 			type &= (COMMSK|COMSCAN);
 			sh_stats(STAT_SCMDS);
 			error_info.line = t->com.comline-sh.st.firstline;
+			sh_profline(error_info.line);
 			com = sh_argbuild(&argn,&(t->com),flags & ARG_OPTIMIZE);
 			echeck = 1;
 			if(t->tre.tretyp&COMSCAN)
@@ -1021,7 +1061,9 @@ int sh_exec(const Shnode_t *t, int flags)
 					Namval_t *tp=0;
 					if(argn)
 					{
-						if(checkopt(com,'A'))
+						if(checkopt(com,'O'))
+							flgs |= NV_ARRAY|NV_AORDER;
+						else if(checkopt(com,'A'))
 							flgs |= NV_ARRAY;
 						else if(checkopt(com,'a'))
 							flgs |= NV_IARRAY;
@@ -1048,7 +1090,10 @@ int sh_exec(const Shnode_t *t, int flags)
 						else if(argn>=3 && checkopt(com,'T'))
 						{
 							if(sh.subshell && !sh.subshare)
+							{
+								sh_stats(STAT_SFTYPE);
 								sh_subfork();
+							}
 #if SHOPT_NAMESPACE
 							if(sh.namespace)
 							{
@@ -1239,6 +1284,8 @@ int sh_exec(const Shnode_t *t, int flags)
 						}
 						if(!(nv_isattr(np,BLT_ENV)))
 						{
+							/* may be a file system utility from libcmd */
+							path_dirchange();
 							sfsync(NULL);
 							share = sfset(sfstdin,SFIO_SHARE,0);
 							sh_onstate(SH_STOPOK);
@@ -1479,6 +1526,10 @@ int sh_exec(const Shnode_t *t, int flags)
 			pid_t parent;
 			int no_fork,jobid;
 			int pipes[3];
+#if SHOPT_SPAWN
+			char **argv;
+#endif /* SHOPT_SPAWN */
+			sh_profline(t->fork.forkline-sh.st.firstline);
 			if(sh.subshell)
 				sh_subtmpfile();
 			if(no_fork = check_exec_optimization(type,execflg,execflg2,t->fork.forkio))
@@ -1486,14 +1537,19 @@ int sh_exec(const Shnode_t *t, int flags)
 			else
 			{
 #if SHOPT_BGX
-				int maxjob;
+				int maxjob, nochild;
 				if(((type&(FAMP|FINT)) == (FAMP|FINT)) && (maxjob=nv_getnum(JOBMAXNOD))>0)
 				{
+					/* sleep in waitpid(2) until a job terminates, running any traps that interrupt it */
 					while(job.numbjob >= maxjob)
 					{
 						job_lock();
-						job_reap(0);
+						nochild = job_reap(0);
 						job_unlock();
+						if(nochild)
+							break;
+						if(sh.trapnote)
+							sh_chktrap();
 					}
 				}
 #endif /* SHOPT_BGX */
@@ -1513,10 +1569,14 @@ int sh_exec(const Shnode_t *t, int flags)
 				if(com && !job.jobcontrol)
 #endif /* _use_ntfork_tcpgrp */
 				{
-					parent = sh_ntfork(t,com,&jobid,topfd);
+					parent = sh_ntfork(t,com,&jobid,topfd,0);
 					if(parent<0)
 						break;
 				}
+				/* pipeline element or background job that runs a simple external command */
+				else if(!com && (type&(FPIN|FPOU|FAMP)) && (argv=ntfork_args(t,type))
+				&& (parent = sh_ntfork(t->fork.forktre,argv,&jobid,topfd,type)) > 0)
+					;
 				else
 #endif /* SHOPT_SPAWN */
 					parent = sh_fork(type,&jobid);
@@ -1723,6 +1783,7 @@ int sh_exec(const Shnode_t *t, int flags)
 				{
 					if((i->iofile & ~(IOUFD|IOPUT)) == (IOMOV|IORAW) && !strcmp(i->ioname,"-"))
 					{
+						sh_stats(STAT_SFREDIR);
 						sh_subfork();
 						break;
 					}
@@ -2003,8 +2064,13 @@ int sh_exec(const Shnode_t *t, int flags)
 				goto endfor;
 #endif /* SHOPT_OPTIMIZE */
 			error_info.line = t->for_.forline-sh.st.firstline;
+			sh_profline(error_info.line);
 			if(!(tp=t->for_.forlst))
 			{
+#if SHOPT_FILESCAN
+				if(sh_scanpending())
+					sh_scanargs();
+#endif /* SHOPT_FILESCAN */
 				args=sh.st.dolv+1;
 				nargs = sh.st.dolc;
 				argsav=sh_arguse();
@@ -2125,21 +2191,28 @@ int sh_exec(const Shnode_t *t, int flags)
 			Namval_t *np;
 			Shbltin_f fp;
 #if SHOPT_FILESCAN
-			Sfio_t *iop=0;
+			Sfio_t *volatile iop=0;
 			int savein=-1;
+			char *savline = sh.cur_line;
+			struct Filescan scan;
 #endif /* SHOPT_FILESCAN */
-#if SHOPT_OPTIMIZE
+#if SHOPT_OPTIMIZE || SHOPT_FILESCAN
 			int  jmpval = ((struct checkpt*)sh.jmplist)->mode;
 			struct checkpt *buffp = stkalloc(sh.stk,sizeof(struct checkpt));
+#endif /* SHOPT_OPTIMIZE || SHOPT_FILESCAN */
+#if SHOPT_OPTIMIZE
 			void *optlist = sh.optlist;
 			sh.optlist = 0;
 			sh_tclear(t->wh.whtre);
 			sh_tclear(t->wh.dotre);
+#endif /* SHOPT_OPTIMIZE */
+#if SHOPT_OPTIMIZE || SHOPT_FILESCAN
+			/* the filescan state below must also be undone if the loop is left by a longjmp */
 			sh_pushcontext(buffp,jmpval);
 			jmpval = sigsetjmp(buffp->buff,0);
 			if(jmpval)
 				goto endwhile;
-#endif /* SHOPT_OPTIMIZE */
+#endif /* SHOPT_OPTIMIZE || SHOPT_FILESCAN */
 #if SHOPT_FILESCAN
 			/* Recognize filescan loop for a lone input redirection following 'while' */
 			if(type==TWH					/* 'while' (not 'until') */
@@ -2152,6 +2225,9 @@ int sh_exec(const Shnode_t *t, int flags)
 			&& !sh_isoption(SH_POSIX))			/* not in POSIX compliance mode */
 			{
 				iop = openstream(tt->com.comio,&savein);
+				memset(&scan,0,sizeof(scan));
+				scan.prev = sh.filescan;
+				sh.filescan = &scan;
 			}
 #endif /* SHOPT_FILESCAN */
 			/* Optimization: don't call sh_exec() for simple 'while :', 'while true' or 'until false' */
@@ -2169,8 +2245,12 @@ int sh_exec(const Shnode_t *t, int flags)
 #if SHOPT_FILESCAN
 				if(iop)
 				{
+					scanreset(&scan);
 					if(!(sh.cur_line=sfgetr(iop,'\n',SFIO_STRING)))
 						break;
+					/* split the line into $1 ... $n when one is first used */
+					scan.dolv = sh.st.dolv;
+					scan.dolh = sh_arguse();
 				}
 				else
 #endif /* SHOPT_FILESCAN */
@@ -2185,25 +2265,16 @@ int sh_exec(const Shnode_t *t, int flags)
 					sh_exec((Shnode_t*)t->wh.whinc,first);
 				first = 0;
 				errorflg &= ~ARG_OPTIMIZE;
-#if SHOPT_FILESCAN
-				sh.offsets[0] = -1;
-				sh.offsets[1] = 0;
-#endif /* SHOPT_FILESCAN */
 			}
-#if SHOPT_OPTIMIZE
+#if SHOPT_OPTIMIZE || SHOPT_FILESCAN
 		endwhile:
 			sh_popcontext(buffp);
+#endif /* SHOPT_OPTIMIZE || SHOPT_FILESCAN */
+#if SHOPT_OPTIMIZE
 			sh_tclear(t->wh.whtre);
 			sh_tclear(t->wh.dotre);
 			sh_optclear(optlist);
-			if(jmpval)
-				siglongjmp(*sh.jmplist,jmpval);
 #endif /* SHOPT_OPTIMIZE */
-			/* decrease 'break' level */
-			if(sh.st.breakcnt>0)
-				sh.st.breakcnt--;
-			sh.st.loopcnt--;
-			sh.exitval= r;
 #if SHOPT_FILESCAN
 			if(iop)
 			{
@@ -2212,9 +2283,23 @@ int sh_exec(const Shnode_t *t, int flags)
 				while(close(0)<0 && errno==EINTR)
 					errno = err;
 				dup(savein);
-				sh.cur_line = 0;
+				close(savein);
+				scanreset(&scan);
+				free(scan.buf);
+				free(scan.argv);
+				sh.filescan = scan.prev;
+				sh.cur_line = savline;
 			}
 #endif /* SHOPT_FILESCAN */
+#if SHOPT_OPTIMIZE || SHOPT_FILESCAN
+			if(jmpval)
+				siglongjmp(*sh.jmplist,jmpval);
+#endif /* SHOPT_OPTIMIZE || SHOPT_FILESCAN */
+			/* decrease 'break' level */
+			if(sh.st.breakcnt>0)
+				sh.st.breakcnt--;
+			sh.st.loopcnt--;
+			sh.exitval= r;
 			break;
 		    }
 
@@ -2226,6 +2311,7 @@ int sh_exec(const Shnode_t *t, int flags)
 			char *trap;
 			char *arg[4];
 			error_info.line = t->ar.arline-sh.st.firstline;
+			sh_profline(error_info.line);
 			arg[0] = "((";
 			if(!(t->ar.arexpr->argflag&ARG_RAW))
 				arg[1] = sh_macpat(t->ar.arexpr,(flags & ARG_OPTIMIZE)|ARG_ARITH);
@@ -2267,6 +2353,7 @@ int sh_exec(const Shnode_t *t, int flags)
 			const int eflag = flags & sh_state(SH_ERREXIT);
 			char *r = sh_macpat(t->sw.swarg, flags & ARG_OPTIMIZE);
 			error_info.line = t->sw.swline - sh.st.firstline;
+			sh_profline(error_info.line);
 			if(sh.st.trap[SH_DEBUGTRAP])
 			{
 				char *av[4];
@@ -2284,11 +2371,12 @@ int sh_exec(const Shnode_t *t, int flags)
 				{
 					const unsigned char raw = rex->argflag & ARG_RAW;
 					char *s;
+					int m;
 					if(rex->argflag&ARG_MAC)
 						s = sh_macpat(rex,(flags & ARG_OPTIMIZE)|ARG_EXP);
 					else
 						s = rex->argval;
-					if(raw && strcmp(r,s)==0 || !raw && strmatch(r,s))
+					if(raw && strcmp(r,s)==0 || !raw && ((m = sh_simplematch(r,s)) < 0 ? strmatch(r,s) : m))
 					{
 						do
 							sh_exec(t->reg.regcom, t->reg.regflag ? eflag : flags);
@@ -2582,6 +2670,7 @@ int sh_exec(const Shnode_t *t, int flags)
 			if(type&TTEST)
 				skipexitset++;
 			error_info.line = t->tst.tstline-sh.st.firstline;
+			sh_profline(error_info.line);
 			echeck = 1;
 			if((type&TPAREN)==TPAREN)
 			{
@@ -3033,6 +3122,7 @@ int sh_funscope(int argn, char *argv[],int(*fun)(void*),void *arg,int execflg)
 	*prevscope = sh.st;
 	sh_offoption(SH_ERREXIT);
 	sh.st.prevst = prevscope;
+	sh.st.noexports = 0;
 	sh.st.self = savst;
 	sh.topscope = (Shscope_t*)sh.st.self;
 	sh.st.opterror = sh.st.optchar = 0;
@@ -3047,10 +3137,15 @@ int sh_funscope(int argn, char *argv[],int(*fun)(void*),void *arg,int execflg)
 	prevscope->save_tree = sh.var_tree;
 	n = dtvnext(prevscope->save_tree)!= (sh.namespace?sh.var_base:0);
 	sh_scope(envlist,1);
-	if(n)
+	if(n && prevscope->noexports!=ast.env_serial+1)
 	{
-		/* eliminate parent scope */
-		nv_scan(prevscope->save_tree, local_exports, NULL, NV_EXPORT, NV_EXPORT|NV_NOSCOPE);
+		/*
+		 * eliminate parent scope; if it has no exported variables, remember that
+		 * until the next env_change() so that further calls need not scan it
+		 */
+		sh_stats(STAT_SCOPESCAN);
+		if(!nv_scan(prevscope->save_tree, local_exports, NULL, NV_EXPORT, NV_EXPORT|NV_NOSCOPE))
+			prevscope->noexports = ast.env_serial+1;
 	}
 	sh.st.save_tree = sh.var_tree;
 	if(!fun)
@@ -3110,6 +3205,7 @@ int sh_funscope(int argn, char *argv[],int(*fun)(void*),void *arg,int execflg)
 		}
 		sh.fn_depth++;
 		update_sh_level();
+		sh_profcall(sh.st.funname);
 		if(fun)
 			r= (*fun)(arg);
 		else
@@ -3364,17 +3460,78 @@ static void sigreset(int mode)
 	}
 }
 
+/*
+ * If the TFORK node <t> of type <type> does nothing but run an external
+ * command with literal arguments, return that command's argument list so
+ * that sh_ntfork() can spawn it without forking the shell. The command
+ * must not need anything the forked child would do before running it:
+ * no assignments, redirections, function or built-in lookup, xtrace or
+ * DEBUG trap output, etc. Process group and terminal setup for job control
+ * is done by spawnveg(3), as for any command spawned by sh_ntfork().
+ */
+static char **ntfork_args(const Shnode_t *t,int type)
+{
+	const Shnode_t	*tp = t->fork.forktre;
+	struct dolnod	*dp;
+	char		*cp;
+	if((type&FCOOP) || t->fork.forkio || (tp->tre.tretyp&(COMMSK|COMSCAN))!=TCOM)
+		return NULL;
+	if(tp->com.comset || tp->com.comio || tp->com.comnamp || !(dp=tp->com.comarg.dp) || dp->dolnum<1)
+		return NULL;
+	if(sh_isoption(SH_XTRACE) || sh_isoption(SH_SHOWME) || sh_isoption(SH_RESTRICTED) || sh.st.trap[SH_DEBUGTRAP])
+		return NULL;
+#if !_use_ntfork_tcpgrp
+	if(job.jobcontrol)
+		return NULL;
+#endif /* !_use_ntfork_tcpgrp */
+#if _lib_nice
+	if((type&FAMP) && sh_isoption(SH_BGNICE))
+		return NULL;
+#endif /* _lib_nice */
+#if !SHOPT_DEVFD
+	if(sh.fifo)
+		return NULL;
+#endif /* !SHOPT_DEVFD */
+	cp = dp->dolval[dp->dolbot];
+	if(!strchr(cp,'/'))
+	{
+		/* no function, built-in, or autoloadable function; must be found on $PATH */
+		if(nv_search(cp,sh.fun_tree,0) || path_search(cp,NULL,2) || !*(cp=stkptr(sh.stk,PATH_OFFSET)))
+			return NULL;
+	}
+	if(nv_search(cp,sh.bltin_tree,0))
+		return NULL;
+	return dp->dolval+dp->dolbot;
+}
+
+/*
+ * Make <fd> a copy of <f1> in the parent until sh_iorestore(topfd)
+ */
+static void ntfork_dupfd(int f1,int fd,int topfd)
+{
+	sh_iosave(fd,topfd,NULL);
+	sh_iorenumber(sh_fcntl(f1,F_DUPFD,10),fd);
+}
+
 /*
  * A combined fork/exec for systems with slow fork().
  * Incompatible with job control on interactive shells (job.jobcontrol) if
  * the system does not support posix_spawn_file_actions_addtcsetpgrp_np().
+ *
+ * If <flags> is nonzero, <t> is the command of a TFORK node with those flags
+ * (see ntfork_args()) and the file descriptor and signal setup of the forked
+ * child is done around the spawn instead. If the command cannot be spawned,
+ * -1 is returned without an error message so the caller can fork instead.
  */
-static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
+static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd,int flags)
 {
 	static pid_t	spawnpid;
 	struct checkpt	*buffp = stkalloc(sh.stk,sizeof(struct checkpt));
 	int		jmpval,jobfork=0;
-	volatile int	scope=0, sigwasset=0;
+	static void	(*sigint)(int), (*sigquit)(int);
+	volatile int	scope=0, sigwasset=0, nointr=0, ioset=sh.st.ioset;
+	volatile int	pipefd[4], clexec[4], npipefd=0;
+	int		n;
 	char		**arge, *path;
 	volatile pid_t	grp = 0;
 	Pathcomp_t	*pp;
@@ -3388,6 +3545,38 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 	if(jmpval == 0)
 	{
 		spawnpid = -1;
+		if((flags&FINT) && !sh_isstate(SH_MONITOR))
+		{
+			/* default std input for & */
+			sigint = signal(SIGINT,SIG_IGN);
+			sigquit = signal(SIGQUIT,SIG_IGN);
+			nointr = 1;
+			if(!sh.st.ioset)
+			{
+				sh_iosave(0,topfd,NULL);
+				sh_iorenumber(sh_iomovefd(sh_chkopen(e_devnull)),0);
+			}
+		}
+		if(flags&FPIN)
+		{
+			ntfork_dupfd(sh.inpipe[0],0,topfd);
+			pipefd[npipefd++] = sh.inpipe[0];
+			pipefd[npipefd++] = sh.inpipe[1];
+		}
+		if(flags&FPOU)
+		{
+			ntfork_dupfd(sh.outpipe[1],1,topfd);
+			pipefd[npipefd++] = sh.outpipe[0];
+			pipefd[npipefd++] = sh.outpipe[1];
+		}
+		/* the child must not inherit the original pipe ends, or a reader never gets end of file or SIGPIPE */
+		for(n=0; n < npipefd; n++)
+		{
+			if(pipefd[n] >= 0 && !((clexec[n] = fcntl(pipefd[n],F_GETFD,0)) & FD_CLOEXEC))
+				fcntl(pipefd[n],F_SETFD,FD_CLOEXEC);
+			else
+				pipefd[n] = -1;
+		}
 		if(t->com.comio)
 			sh_redirect(t->com.comio,0);
 		error_info.id = *argv;
@@ -3440,14 +3629,15 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 			signal(SIGTSTP,SIG_DFL);
 			jobwasset++;
 		}
-		if(sh_isstate(SH_MONITOR) && job.jobcontrol)
+#endif /* _use_ntfork_tcpgrp */
+		/* as in _sh_fork(), a background job or the first command of a job leads a new process group */
+		if(sh_isstate(SH_MONITOR))
 		{
-			if(job.curpgid==0)
+			if(job.curpgid==0 || (flags&FAMP))
 				grp = 1;
 			else
 				grp = job.curpgid;
 		}
-#endif /* _use_ntfork_tcpgrp */
 
 		sfsync(NULL);
 		sigreset(0);	/* set signals to ignore */
@@ -3456,8 +3646,8 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 		for(pp=path_get(argv[0]); pp && !pp->lib ; pp=pp->next);
 		job_fork(-1);
 		jobfork = 1;
-		spawnpid = path_spawn(path,argv,arge,pp,(grp<<1)|1);
-		if(spawnpid < 0 && errno==ENOEXEC)
+		spawnpid = path_spawn(path,argv,arge,pp,(grp<<3)|((flags&FAMP)?4:0)|(flags?3:1));
+		if(spawnpid < 0 && errno==ENOEXEC && !flags)
 		{
 			char *devfd;
 			int fd = open(path,O_RDONLY);
@@ -3472,7 +3662,7 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 			}
 			if(!sh.shpath)
 				sh.shpath = pathshell();
-			spawnpid = path_spawn(sh.shpath,&argv[-1],arge,pp,(grp<<1)|1);
+			spawnpid = path_spawn(sh.shpath,&argv[-1],arge,pp,(grp<<3)|1);
 			if(fd>=0)
 				close(fd);
 			argv[0] = argv[-1];
@@ -3495,6 +3685,8 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 			if(job.jobcontrol)
 				tcsetpgrp(job.fd,sh.pid);
 #endif /* _use_ntfork_tcpgrp */
+			if(flags)
+				goto done;
 			switch(errno=sh.path_err)
 			{
 			    case ENOENT:
@@ -3510,11 +3702,23 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 				UNREACHABLE();
 			}
 		}
+	done:
 		job_unlock();
 	}
 	else
 		exitset();
 	sh_popcontext(buffp);
+	while(--npipefd >= 0)
+	{
+		if(pipefd[npipefd] >= 0)
+			fcntl(pipefd[npipefd],F_SETFD,clexec[npipefd]);
+	}
+	if(nointr)
+	{
+		signal(SIGINT,sigint);
+		signal(SIGQUIT,sigquit);
+	}
+	sh.st.ioset = ioset;
 	if(buffp->olist)
 		free_list(buffp->olist);
 #if _use_ntfork_tcpgrp
@@ -3537,15 +3741,15 @@ static pid_t sh_ntfork(const Shnode_t *t,char *argv[],int *jobid,int topfd)
 		if(jmpval==SH_JMPSCRIPT)
 			nv_setlist(t->com.comset,NV_EXPORT|NV_IDENT|NV_ASSIGN,0);
 	}
-	if(t->com.comio && (jmpval || spawnpid<=0) && sh.topfd > topfd)
+	if((flags || t->com.comio && (jmpval || spawnpid<=0)) && sh.topfd > topfd)
 		sh_iorestore(topfd,jmpval);
 	if(jmpval>SH_JMPCMD)
 		siglongjmp(*sh.jmplist,jmpval);
 	if(spawnpid>0)
 	{
-		_sh_fork(spawnpid,0,jobid);
+		_sh_fork(spawnpid,flags,jobid);
 		job_fork(spawnpid);
-		if(grp==1)
+		if(grp==1 && !(flags&FAMP))
 			job.curpgid = spawnpid;
 	}
 	return spawnpid;
@@ -1057,5 +1057,26 @@ integer 20 got=$exp
 [[ $got == "$exp" ]] || err_exit "negative base-20 number (expected '$exp', got '$got')"
 unset got
 
+# ======
+# integer arithmetic fast path and constant folding must not change results
+got=$(
+	typeset -i i=9223372036854775807 j
+	((j = i * 2)); print -rn -- "$j "
+	typeset -si s=32767; ((s++)); print -rn -- "$s "
+	integer w=3; print -rn -- "$(( w += w *= 2 )) "
+	integer t=4; function f { typeset -i t=10; ((t+=1)); print -rn -- "$t "; }; f; print -rn -- "$t "
+	integer e=7; ((e = (e > 5) ? e << 2 : ~e)); print -rn -- "$e "
+	print -rn -- "$((2*3+4)) $(( 1 ? 2 : 3 + 4 )) $(( (1 ? 2 : 3) + 4 )) $((7/2)) $((-7%3)) $((4%-1)) "
+	print -rn -- "$(( -(1<<63) )) $((1<<64)) "
+	typeset -ui u=5; ((u -= 10)); print -rn -- "$u "
+	float x=1.5; integer z=2; ((z = z*x)); print -rn -- "$z "
+	integer a; a[3]=4; ((a[3]+=1)); print -rn -- "${a[3]} "
+	integer d=5; ( ((d = d/0)) ) 2>/dev/null; print -rn -- "$? "
+	integer g=5; readonly g; ( ((g = 6)) ) 2>/dev/null; print -r -- "$? $g"
+)
+exp='-2 -32768 9 11 4 28 10 2 6 3 -1 0 9.22337203685477581e+18 1 4294967291 3 5 1 1 5'
+[[ $got == "$exp" ]] || err_exit "integer arithmetic fast path" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
 # ======
 exit $((Errors<125?Errors:125))
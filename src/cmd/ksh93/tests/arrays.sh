@@ -942,5 +942,82 @@ exp='typeset -A -i yarr=([foo=bar]=123 [lorem=ipsum]=456)'
 [[ $got == "$exp" ]] || err_exit "associative array index containing '=' misparsed in declaration command" \
 	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
 
+# ======
+# Indexed arrays are stored in blocks, so large and scattered subscripts must not allocate all the elements below them
+got=$(
+	unset ar
+	ar[4000000]=x ar[70]=y ar[5]=z
+	print -r -- "${!ar[@]}" "${ar[@]}" "${#ar[@]}"
+	unset ar[70]
+	ar+=(w)
+	print -r -- "${!ar[@]}"
+)
+exp=$'5 70 4000000 z y x 3
+5 4000000 4000001'
+[[ $got == "$exp" ]] || err_exit "sparse indexed array" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# Integer and float array values are packed; they must survive subshells, attribute changes and conversion
+got=$(
+	integer -a ar=(1 2 3)
+	(ar[1]=5 ar[7]=1)
+	typeset -p ar
+	typeset -F2 ar
+	ar[1]+=1.5
+	typeset -p ar
+	typeset -i ar
+	typeset -A ar
+	ar[x]=4
+	print -r -- "${ar[0]} ${ar[1]} ${ar[2]} ${ar[x]}"
+	typeset -lF fl=(1.5 2.5)
+	unset fl[0]
+	fl[3]=4
+	typeset -p fl
+)
+exp=$'typeset -a -l -i ar=(1 2 3)\ntypeset -a -F 2 ar=(1.00 3.50 3.00)\n1 3 3 4\ntypeset -a -l -F fl=([1]=2.5000000000 [3]=4.0000000000)'
+[[ $got == "$exp" ]] || err_exit "packed numeric array" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# Associative arrays are hashed, but their subscripts must still be listed in sorted order
+got=$(
+	typeset -A m
+	integer i
+	for((i=0; i<300; i++)); do m[k$(( (i*37) % 300 ))]=$i; done
+	for((i=0; i<300; i+=3)); do unset "m[k$i]"; done
+	m[a]=1 m[z]=2
+	n=0 prev=
+	for k in "${!m[@]}"; do [[ $prev < $k ]] || print -r "out of order: $prev $k"; prev=$k; ((n++)); done
+	print -r -- "$n ${m[k37]} ${m[k3]-unset}"
+	set -- "${!m[@]}"
+	print -r -- "$1 $2 $3"
+	for k in "${!m[@]}"; do unset "m[$k]"; done
+	print -r -- "${#m[@]}"
+)
+exp=$'202 1 unset\na k1 k10\n0'
+[[ $got == "$exp" ]] || err_exit "hashed associative array" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# typeset -O lists the subscripts of an associative array in the order they were added
+got=$(
+	typeset -O m=([zz]=1 [b]=2 [a]=3)
+	m[c]=4
+	unset m[b]
+	m[b]=5 m[zz]=6
+	print -r -- "${!m[@]}"
+	typeset -p m
+	(m[aa]=7; print -r -- "${!m[@]}")
+	m=([k]=1 [j]=2)
+	print -r -- "${!m[@]}"
+	function f { typeset -O l=([q]=1 [p]=2); l[o]=3; print -r -- "${!l[@]}"; }
+	f
+	typeset -A n=([y]=1 [x]=2)
+	typeset -O n
+	n[w]=3
+	print -r -- "${!n[@]}"
+)
+exp=$'zz a c b\ntypeset -A -O m=([zz]=6 [a]=3 [c]=4 [b]=5)\nzz a c b aa\nk j\nq p o\nx y w'
+[[ $got == "$exp" ]] || err_exit "typeset -O" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
 # ======
 exit $((Errors<125?Errors:125))
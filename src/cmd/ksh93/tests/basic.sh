@@ -1026,5 +1026,69 @@ do
 done
 unset testcode
 
+# ======
+# Parse trees of command substitutions, arithmetic expansions, eval strings and trap actions are cached
+got=$("$SHELL" -c '
+	typeset -i i n=0
+	for ((i=0; i<3; i++))
+	do	x=`print -n $i`$(print -n $i)${ print -n $i; }$((i*2))
+		eval "n+=1"
+	done
+	print -r -- "$x $n"
+' 2>&1)
+[[ $got == '2224 3' ]] || err_exit "repeated comsubs/eval give wrong results (got $(printf %q "$got"))"
+got=$("$SHELL" -c '
+	alias foo="print -n one"
+	for i in 1 2
+	do	eval foo
+		alias foo="print -n two"
+	done
+	print
+	for i in 1 2
+	do	x=`foo`
+		print -n "$x"
+		unalias foo
+		foo() { print -n three; }
+	done
+	print
+' 2>&1)
+[[ $got == $'onetwo\ntwothree' ]] || err_exit "cached parse trees not invalidated after alias change (got $(printf %q "$got"))"
+got=$("$SHELL" -c '
+	print `print $LINENO` $(print $LINENO)
+	print `print $LINENO` $(print $LINENO)
+' 2>&1)
+[[ $got == $'2 2\n3 3' ]] || err_exit "cached parse trees use wrong line numbers (got $(printf %q "$got"))"
+cat >$tmp/lineno.sh <<\EOF
+for i in 1 2
+do	eval $'\n\nprint -r "$LINENO"; (( 1/0 ))'
+	x=`print $LINENO
+	print $LINENO`
+	print -r -- $x $LINENO
+done
+EOF
+exp=$'3\nlineno.sh[2]: eval: line 3:  1/0 : divide by zero\n3 4 5'
+exp+=$'\n'$exp
+got=$(cd "$tmp" && "$SHELL" lineno.sh 2>&1)
+[[ $got == "$exp" ]] || err_exit "line numbers differ when a cached parse tree is reused" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+got=$("$SHELL" -c 'for i in 1 2; do eval "print \$(print a) \$(print b) \$(print ab) \$(print a)"; done' 2>&1)
+exp=$'a b ab a\na b ab a'
+[[ $got == "$exp" ]] || err_exit "cached trees of command substitutions on one line mixed up" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+if	((SHOPT_STATS))
+then	got=$("$SHELL" -c '
+		for i in 1 2 3; do : $(:) `:`; eval :; done
+		print ${.sh.stats.parse_cachehits} ${.sh.stats.parse_cachemiss}
+	' 2>&1)
+	[[ $got == '6 3' ]] || err_exit ".sh.stats parse cache counters wrong (expected '6 3', got $(printf %q "$got"))"
+fi
+
+# ======
+# Line numbers of redirection errors on compound commands, background jobs and pipeline elements were one too low
+for cmd in '{ :; } </dev/null/nonexistent' '{ :; } </dev/null/nonexistent &' '{ :; } </dev/null/nonexistent | :'
+do	got=$("$SHELL" -c $'true\n'"$cmd"$'\nwait' 2>&1)
+	[[ $got == *': line 2: '* ]] || err_exit "wrong line number in error from '$cmd' (got $(printf %q "$got"))"
+done
+
 # ======
 exit $((Errors<125?Errors:125))
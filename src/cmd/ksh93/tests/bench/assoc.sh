@@ -0,0 +1,70 @@
+########################################################################
+#                                                                      #
+#               This software is part of the ast package               #
+#          Copyright (c) 2020-2026 Contributors to ksh 93u+m           #
+#                      and is licensed under the                       #
+#                 Eclipse Public License, Version 2.0                  #
+#                                                                      #
+#                A copy of the License is available at                 #
+#      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      #
+#         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         #
+#                                                                      #
+#                  Martijn Dekker <martijn@inlv.org>                   #
+#                                                                      #
+########################################################################
+
+# Associative array benchmark: insert, look up and list n keys (default
+# 10^6). The keys k0..k<n-1> are inserted and looked up in a scattered
+# order, or in numeric order if 'inorder' is given as the second operand.
+# With -O, the array lists its subscripts in insertion order (typeset -O).
+#
+# usage: assoc.sh [-O] [n [inorder]]
+
+typeset -A m
+if	[[ $1 == -O ]]
+then	typeset -O m
+	shift
+fi
+typeset -i n=${1:-1000000} step=7919 i
+[[ $2 == inorder ]] && step=1
+((n % step || step == 1)) || step=7927
+typeset -F3 SECONDS
+
+function report
+{
+	printf '%-20s %8.3f s\n' "$1" $((SECONDS - t))
+	t=$SECONDS
+}
+
+if	((step == 1))
+then	print -r -- "$n keys in numeric order"
+else	print -r -- "$n keys in scattered order"
+fi
+t=$SECONDS
+for ((i=0; i<n; i++))
+do	m[k$(( i*step % n ))]=$i
+done
+report insert
+for ((i=0; i<n; i++))
+do	: ${m[k$(( i*step % n ))]}
+done
+report lookup
+for k in "${!m[@]}"
+do	:
+done
+report 'first ${!m[@]}'
+for k in "${!m[@]}"
+do	:
+done
+report 'next ${!m[@]}'
+for ((i=0; i<n; i+=2))
+do	unset "m[k$(( i*step % n ))]"
+done
+report 'unset half'
+if	[[ -r /proc/$$/status ]]
+then	while read -r k v
+	do	if	[[ $k == Vm@(HWM|RSS): ]]
+		then	printf '%-20s %8s\n' "${k%:}" "$v"
+		fi
+	done < /proc/$$/status
+fi
@@ -0,0 +1,50 @@
+########################################################################
+#                                                                      #
+#               This software is part of the ast package               #
+#            Copyright (c) 2026 Contributors to ksh 93u+m              #
+#                      and is licensed under the                       #
+#                 Eclipse Public License, Version 2.0                  #
+#                                                                      #
+#                A copy of the License is available at                 #
+#      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      #
+#         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         #
+#                                                                      #
+#                  Martijn Dekker <martijn@inlv.org>                   #
+#                                                                      #
+########################################################################
+
+# Large file copy benchmark: copy a file of n megabytes (default 512) with
+# the cp built-in within a file system and to another directory (default
+# /dev/shm, usually on tmpfs), move it back with the mv built-in, and copy
+# it with the external cp(1) for comparison. The file is created in $TMPDIR
+# or /tmp and read once first, so the times are for a warm cache.
+#
+# usage: cp.sh [n [otherdir]]
+
+typeset -i n=${1:-512}
+other=${2:-/dev/shm}
+typeset -F3 SECONDS t
+
+builtin cp mv || exit
+extcp=$(whence -p cp)
+dir=${TMPDIR:-/tmp}/ksh93.bench.$$
+other=$other/ksh93.bench.$$
+mkdir "$dir" "$other" || exit
+trap 'rm -rf "$dir" "$other"' EXIT
+head -c $((n*1024*1024)) /dev/urandom >"$dir/src" || exit
+cat "$dir/src" >/dev/null
+
+function timed
+{
+	typeset what=$1
+	shift
+	t=$SECONDS
+	"$@" || exit
+	printf '%-24s %8.3f s  %6.0f MB/s\n' "$what" $((SECONDS - t)) $((n / (SECONDS - t)))
+}
+
+timed "cp" cp "$dir/src" "$dir/dst"
+timed "cp over existing file" cp "$dir/src" "$dir/dst"
+timed "cp to ${other%/*}" cp "$dir/src" "$other/dst"
+timed "mv from ${other%/*}" mv "$other/dst" "$dir/mv"
+[[ $extcp ]] && timed "$extcp" "$extcp" "$dir/src" "$dir/ext"
@@ -0,0 +1,136 @@
+/***********************************************************************
+*                                                                      *
+*               This software is part of the ast package               *
+*            Copyright (c) 2026 Contributors to ksh 93u+m              *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*                                                                      *
+***********************************************************************/
+/*
+ * Compare the cdt methods on a lookup-heavy workload: insert n string
+ * keys, then search for each of them (hit) and for n keys that are not
+ * there (miss), all in a random order. Times are in ns per operation.
+ *
+ * Build it against an installed libast, e.g. from the top directory:
+ *
+ *	a=arch/$(bin/package host)
+ *	cc -O2 -I$a/include/ast -o dtbench src/cmd/ksh93/tests/bench/dtbench.c $a/lib/libast.a -lm
+ *
+ * usage: dtbench [n ...]
+ */
+
+#include	<ast.h>
+#include	<cdt.h>
+#include	<error.h>
+#include	<time.h>
+
+typedef struct Obj_s
+{
+	Dtlink_t	link;
+	char		*key;
+} Obj_t;
+
+static Dtdisc_t	disc =
+{
+	offsetof(Obj_t,key), -1, 0
+};
+
+static const struct
+{
+	const char	*name;
+	Dtmethod_t	**meth;
+} methods[] =
+{
+	"Dtoset",	&Dtoset,
+	"Dtset",	&Dtset,
+	"Dtopset",	&Dtopset,
+	"Dtpset",	&Dtpset,
+};
+
+static double now(void)
+{
+	struct timespec	ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec*1e9 + ts.tv_nsec;
+}
+
+/* shuffle the objects with a fixed seed, so every method gets the same order */
+static void shuffle(Obj_t **v, size_t n)
+{
+	uint64_t	x = 88172645463325252ULL;
+	size_t		i, j;
+	Obj_t		*t;
+	for(i = n; i > 1; i--)
+	{
+		x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+		j = x % i;
+		t = v[i-1], v[i-1] = v[j], v[j] = t;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const size_t	sizes[] = { 64, 1000, 30000, 1000000 };
+	size_t		nsizes = argc > 1 ? argc - 1 : elementsof(sizes);
+	size_t		s, n, i, m, r, rounds;
+	Obj_t		*obj, **hit, **miss;
+	Dt_t		*dt;
+	double		t, tins, thit, tmiss;
+	sfprintf(sfstdout,"%-8s %-8s %7s %7s %7s\n","n","method","insert","hit","miss");
+	for(s = 0; s < nsizes; s++)
+	{
+		n = argc > 1 ? strtoul(argv[s+1],NULL,10) : sizes[s];
+		if(n == 0)
+			continue;
+		rounds = n < 2000000 ? 2000000/n : 1;
+		obj = (Obj_t*)calloc(2*n,sizeof(Obj_t));
+		hit = (Obj_t**)malloc(n*sizeof(Obj_t*));
+		miss = (Obj_t**)malloc(n*sizeof(Obj_t*));
+		for(i = 0; i < 2*n; i++)
+		{
+			obj[i].key = malloc(16);
+			sfsprintf(obj[i].key,16,"k%zu",i);
+		}
+		for(i = 0; i < n; i++)
+			hit[i] = &obj[i], miss[i] = &obj[n+i];
+		for(m = 0; m < elementsof(methods); m++)
+		{
+			tins = thit = tmiss = 0;
+			for(r = 0; r < rounds; r++)
+			{
+				shuffle(hit,n);
+				dt = dtopen(&disc,*methods[m].meth);
+				t = now();
+				for(i = 0; i < n; i++)
+					dtinsert(dt,hit[i]);
+				tins += now() - t;
+				shuffle(hit,n);
+				t = now();
+				for(i = 0; i < n; i++)
+					if(!dtmatch(dt,hit[i]->key))
+						error(ERROR_exit(1),"%s: %s not found",methods[m].name,hit[i]->key);
+				thit += now() - t;
+				t = now();
+				for(i = 0; i < n; i++)
+					if(dtmatch(dt,miss[i]->key))
+						error(ERROR_exit(1),"%s: %s found",methods[m].name,miss[i]->key);
+				tmiss += now() - t;
+				dtclose(dt);
+			}
+			sfprintf(sfstdout,"%-8zu %-8s %7.0f %7.0f %7.0f\n",n,methods[m].name,
+				tins/(n*rounds),thit/(n*rounds),tmiss/(n*rounds));
+		}
+		for(i = 0; i < 2*n; i++)
+			free(obj[i].key);
+		free(obj);
+		free(hit);
+		free(miss);
+	}
+	return 0;
+}
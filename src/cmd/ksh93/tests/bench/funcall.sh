@@ -0,0 +1,52 @@
+########################################################################
+#                                                                      #
+#               This software is part of the ast package               #
+#          Copyright (c) 2020-2026 Contributors to ksh 93u+m           #
+#                      and is licensed under the                       #
+#                 Eclipse Public License, Version 2.0                  #
+#                                                                      #
+#                A copy of the License is available at                 #
+#      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      #
+#         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         #
+#                                                                      #
+#                  Martijn Dekker <martijn@inlv.org>                   #
+#                                                                      #
+########################################################################
+
+# Function call benchmark: call a function that declares a local variable
+# n times (default 100000) from a caller with 0, 40 and 500 local variables,
+# and recursively to a depth of 100, n/100 times.
+#
+# usage: funcall.sh [n]
+
+typeset -i n=${1:-100000}
+typeset -F3 SECONDS t
+
+function callee { typeset v=$1; }
+function caller
+{
+	typeset -i i n=$1
+	for ((i=0; i<$2; i++))
+	do	eval "typeset l$i=$i"
+	done
+	t=$SECONDS
+	for ((i=0; i<n; i++))
+	do	callee $i
+	done
+	printf '%-36s %8.3f s\n' "$n calls, caller has $2 locals" $((SECONDS - t))
+}
+function recurse
+{
+	typeset v=$1
+	((v > 0)) && recurse $((v - 1))
+}
+
+caller $n 0
+caller $n 40
+caller $n 500
+typeset -i i
+t=$SECONDS
+for ((i=0; i<n/100; i++))
+do	recurse 100
+done
+printf '%-36s %8.3f s\n' "$((n/100)) recursions of depth 100" $((SECONDS - t))
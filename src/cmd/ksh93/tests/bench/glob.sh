@@ -0,0 +1,67 @@
+########################################################################
+#                                                                      #
+#               This software is part of the ast package               #
+#            Copyright (c) 2026 Contributors to ksh 93u+m              #
+#                      and is licensed under the                       #
+#                 Eclipse Public License, Version 2.0                  #
+#                                                                      #
+#                A copy of the License is available at                 #
+#      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      #
+#         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         #
+#                                                                      #
+#                  Martijn Dekker <martijn@inlv.org>                   #
+#                                                                      #
+########################################################################
+
+# Pathname expansion benchmark: build a tree of n directories (default 100)
+# holding m files each (default 2000), plus one flat directory of n*m files,
+# in $TMPDIR or /tmp. Then time the expansion of patterns that match all
+# names, only directories and only some file names, with and without the
+# globstar option. Each pattern is expanded once before it is timed, so the
+# times are for a warm cache; the difference that avoiding stat(2) makes is
+# largest with a cold cache or on a network file system.
+#
+# usage: glob.sh [n [m]]
+
+typeset -i n=${1:-100} m=${2:-2000} i j c
+typeset -F3 SECONDS t
+typeset -a a
+
+dir=${TMPDIR:-/tmp}/ksh93.bench.$$
+mkdir "$dir" "$dir/flat" || exit
+trap 'rm -rf "$dir"' EXIT
+cd "$dir" || exit
+for ((i=0; i<n; i++))
+do	mkdir "d$i" "d$i/sub" || exit
+	for ((j=0; j<m; j++))
+	do	: >"d$i/f$j.log"
+	done
+done
+cd flat || exit
+for ((i=0; i<n*m; i++))
+do	: >"f$i.txt"
+done
+cd ..
+ln -s d0 link
+
+function timed
+{
+	a=($1)
+	t=$SECONDS
+	a=($1)
+	c=${#a[@]}
+	printf '%-24s %8.3f s  %8d names\n' "$1" $((SECONDS - t)) c
+}
+
+timed '*'
+timed '*/'
+timed '*/*'
+timed '*/*/'
+timed '*/*[0-9]5.log'
+timed 'flat/*'
+timed 'flat/*/'
+timed 'flat/f1*.txt'
+set -o globstar
+timed '**'
+timed '**/'
+timed '**/*.log'
@@ -0,0 +1,40 @@
+########################################################################
+#                                                                      #
+#               This software is part of the ast package               #
+#          Copyright (c) 2020-2026 Contributors to ksh 93u+m           #
+#                      and is licensed under the                       #
+#                 Eclipse Public License, Version 2.0                  #
+#                                                                      #
+#                A copy of the License is available at                 #
+#      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      #
+#         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         #
+#                                                                      #
+#                  Martijn Dekker <martijn@inlv.org>                   #
+#                                                                      #
+########################################################################
+
+# Background job benchmark: start and reap n/5 and then n background jobs
+# (default n is 50000), waiting after every 1000. The second run is done
+# in a command substitution, so it forks in a virtual subshell while the
+# parent shell holds the saved exit statuses of the first run. The time
+# per job should be about the same for both runs.
+#
+# usage: jobs.sh [n]
+
+typeset -i n=${1:-50000}
+
+function fanout
+{
+	typeset -i i n=$1
+	typeset -F3 SECONDS=0
+	for ((i=0; i<n; i++))
+	do	: &
+		((i % 1000 == 999)) && wait
+	done
+	(exit 3) &
+	wait $!
+	printf '%-20s %8.3f s  (exit status %d)\n' "$n jobs" $SECONDS $?
+}
+
+fanout $((n/5))
+print -r -- "$(fanout $n)"
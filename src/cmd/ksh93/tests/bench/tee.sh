@@ -0,0 +1,58 @@
+########################################################################
+#                                                                      #
+#               This software is part of the ast package               #
+#            Copyright (c) 2026 Contributors to ksh 93u+m              #
+#                      and is licensed under the                       #
+#                 Eclipse Public License, Version 2.0                  #
+#                                                                      #
+#                A copy of the License is available at                 #
+#      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      #
+#         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         #
+#                                                                      #
+#                  Martijn Dekker <martijn@inlv.org>                   #
+#                                                                      #
+########################################################################
+
+# Pipeline fan-out benchmark: send a file of n megabytes (default 1024)
+# through pipelines of cat built-ins, and through the tee built-in to one
+# file and to k files (default 4). tee to one file moves the data in the
+# kernel where it can; to more files it copies it through user space. The
+# external cat(1) and tee(1) are timed for comparison. The files are
+# created in $TMPDIR or /tmp and the source is read once first, so the
+# times are for a warm cache.
+#
+# usage: tee.sh [n [k]]
+
+typeset -i n=${1:-1024} k=${2:-4} i
+typeset -F3 SECONDS t
+
+builtin cat || exit
+builtin tee 2>/dev/null || builtin -f cmd tee || exit
+extcat=$(whence -p cat)
+exttee=$(whence -p tee)
+dir=${TMPDIR:-/tmp}/ksh93.bench.$$
+mkdir "$dir" || exit
+trap 'rm -rf "$dir"' EXIT
+head -c $((n*1024*1024)) /dev/urandom >"$dir/src" || exit
+cat "$dir/src" >/dev/null
+for ((i=0; i<k; i++))
+do	files[i]=$dir/out$i
+done
+
+function timed
+{
+	typeset what=$1
+	shift
+	t=$SECONDS
+	eval "$@" || exit
+	printf '%-24s %8.3f s  %6.0f MB/s\n' "$what" $((SECONDS - t)) $((n / (SECONDS - t)))
+}
+
+timed "cat|cat|cat" 'cat "$dir/src" | cat | cat >/dev/null'
+[[ $extcat ]] && timed "external cat|cat|cat" '"$extcat" "$dir/src" | "$extcat" | "$extcat" >/dev/null'
+timed "tee 1 file" 'cat "$dir/src" | tee "${files[0]}" | cat >/dev/null'
+timed "tee $k files" 'cat "$dir/src" | tee "${files[@]}" | cat >/dev/null'
+if	[[ $exttee ]]
+then	timed "external tee 1 file" 'cat "$dir/src" | "$exttee" "${files[0]}" | cat >/dev/null'
+	timed "external tee $k files" 'cat "$dir/src" | "$exttee" "${files[@]}" | cat >/dev/null'
+fi
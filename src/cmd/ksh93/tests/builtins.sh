@@ -1697,5 +1697,35 @@ case $(PATH=/opt/ast/bin:$PATH; exec cat '--???SECTION' </dev/null 2>&1) in
 1)	err_exit "'exec' runs non-external command" ;;
 esac
 
+# ======
+# mapfile/readarray
+tmp_lines=$tmp/mapfile.txt
+printf '%s\n' one 'two  2' 'th\ree' four five > $tmp_lines
+exp=$'typeset -a a=($\'one\\n\' $\'two  2\\n\' $\'th\\\\ree\\n\' $\'four\\n\' $\'five\\n\')'
+got=$(mapfile a < $tmp_lines; typeset -p a)
+[[ $got == "$exp" ]] || err_exit "mapfile without options" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+exp="typeset -a a=(x two 'th\\ree' four e)"
+got=$(a=(x y z d e); mapfile -t -s 1 -n 3 -O 1 a < $tmp_lines; a[1]=${a[1]%% *}; typeset -p a)
+[[ $got == "$exp" ]] || err_exit "mapfile -t -s 1 -n 3 -O 1" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+exp="typeset -a MAPFILE=(a b '' c)"
+got=$(printf 'a\0b\0\0c' | readarray -d '' -t; typeset -p MAPFILE)
+[[ $got == "$exp" ]] || err_exit "readarray -d ''" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+exp=$'typeset -a a=(one)\ntwo  2'
+got=$(cat $tmp_lines | { mapfile -t -n 1 a; read -r b; typeset -p a; print -r -- "$b"; })
+[[ $got == "$exp" ]] || err_exit "mapfile -n reads past its last line on a pipe" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+exp="typeset -a a=(1 2 3)"
+got=$(a=(1 2 3); (mapfile a < $tmp_lines); typeset -p a)
+[[ $got == "$exp" ]] || err_exit "mapfile in subshell changes parent's array" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+typeset -A assoc
+got=$(set +x; mapfile assoc < $tmp_lines 2>&1); st=$?
+[[ $st == 1 && $got == *'assoc: not an indexed array' ]] || err_exit "mapfile into associative array" \
+	"(got status $st and $(printf %q "$got"))"
+unset assoc tmp_lines st
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -195,5 +195,36 @@ got=$(set +x; eval '
 [[ $got == "$exp" ]] || err_exit "spurious syntax error in case with extended expression" \
 	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
 
+# ======
+# Literal, prefix, suffix and substring patterns are matched without the regex engine
+got=
+for s in abc abcd xabc xabcx ab '' 'a*c' 'a?c'
+do	case $s in
+	abc)	got+="[lit:$s]" ;;
+	abc*)	got+="[pre:$s]" ;;
+	*abc)	got+="[suf:$s]" ;;
+	*bc*)	got+="[sub:$s]" ;;
+	'a*c')	got+="[q1:$s]" ;;
+	a\?c)	got+="[q2:$s]" ;;
+	*)	got+="[any:$s]" ;;
+	esac
+	[[ $s == *b* ]] && got+="<${.sh.match}>"
+done
+exp='[lit:abc]<abc>[pre:abcd]<abcd>[suf:xabc]<xabc>[sub:xabcx]<xabcx>[any:ab]<ab>[any:][q1:a*c][q2:a?c]'
+[[ $got == "$exp" ]] || err_exit "simple case patterns match incorrectly" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# More distinct patterns than the initial size of the regex cache
+got=
+for ((i=0; i<3; i++))
+do	for s in p1x p7x p29x q
+	do	case $s in
+		p?0x) ;; p1?x) ;; p?2x) ;; p?3x) ;; p?4x) ;; p?5x) ;; p?6x) ;; p?8x) ;; p??9y) ;;
+		p[1]x) got+=1 ;; p[7]x) got+=7 ;; p?(2)9x) got+=29 ;; ?) got+=q ;;
+		esac
+	done
+done
+[[ $got == 1729q1729q1729q ]] || err_exit "case patterns fail when regex cache grows (got $(printf %q "$got"))"
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -1577,5 +1577,54 @@ do	got=$(unset -f "$b"; PATH=/dev/null; "$b" --version 2>&1)
 		"(expected status 2 and ERE match of $(printf %q "$exp"), got status $e and $(printf %q "$got"))"
 done
 
+# ======
+# Exported local variables must be passed on to nested function calls, also when
+# they are exported between calls from the same function (the scan of the calling
+# scope for exported variables is skipped while nothing has been exported since)
+function fx_show { print -r -- "${fx1-unset},${fx2-unset},${fx3-unset}"; }
+function fx_ref { typeset -n r=$1; export r; }
+function fx_caller
+{
+	typeset fx1=a fx2=b fx3
+	fx_show; fx_show
+	export fx1
+	fx_show
+	typeset -x fx2
+	fx_show
+	typeset +x fx1
+	fx_show
+	fx_ref fx1
+	fx_show
+	fx3=c fx_show
+	fx_show
+}
+exp=$'unset,unset,unset\nunset,unset,unset\na,unset,unset\na,b,unset\nunset,b,unset\na,b,unset\na,b,c\na,b,unset'
+got=$(fx_caller 2>&1)
+[[ $got == "$exp" ]] || err_exit "exported local variables not passed on to nested function calls" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+unset -f fx_show fx_ref fx_caller
+
+# ======
+# A function called from one with many non-exported local variables must not rescan them for exports on every call,
+# even if the called function declares a local variable of its own
+if	((SHOPT_STATS))
+then	got=$("$SHELL" -c '
+		function fc_callee { typeset v=$1; }
+		function fc_caller
+		{
+			typeset -i i n=${.sh.stats.scopescans}
+			for ((i=0; i<500; i++))
+			do	eval "typeset l$i=$i"
+			done
+			for ((i=0; i<1000; i++))
+			do	fc_callee $i
+			done
+			print $((${.sh.stats.scopescans} - n))
+		}
+		fc_caller' 2>&1)
+	[[ $got == 1 ]] || err_exit "caller's local variables rescanned for exports on every function call" \
+		"(expected 1 scan for 1000 calls, got $(printf %q "$got"))"
+fi
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -409,6 +409,21 @@ test_glob '<d_un/d_sym//d_3> <d_un/d_sym//d_3/d_4> <d_un/d_sym//d_tres> <d_un/d_
 test_glob '<d_un/d_sym//d_3> <d_un/d_sym//d_3/d_4> <d_un/d_sym//d_tres> <d_un/d_sym//d_tres/d_quatro>' **/d_[s]ym//**
 test_glob '<d_un/d_sym//d_3> <d_un/d_sym//d_3/d_4> <d_un/d_sym//d_tres> <d_un/d_sym//d_tres/d_quatro>' **/d_*ym//**
 
+# Directories are now recognized by the type in their directory entry where available, without stat(2)
+ln -s nonexistent d_un/d_dangling
+mkfifo d_un/d_fifo
+: > d_un/d_file
+set --markdirs
+test_glob '<d_un/d_dangling> <d_un/d_duo/> <d_un/d_fifo> <d_un/d_file> <d_un/d_sym/>' d_un/*
+test_glob '<d_un/d_duo/d_3/> <d_un/d_duo/d_tres/> <d_un/d_sym/d_3/> <d_un/d_sym/d_tres/>' d_un/*/d_*
+test_glob '<d_un/d_dangling> <d_un/d_duo/> <d_un/d_duo/d_3/> <d_un/d_duo/d_3/d_4/> <d_un/d_duo/d_tres/>'\
+' <d_un/d_duo/d_tres/d_quatro/> <d_un/d_fifo> <d_un/d_file> <d_un/d_sym/> <d_un/d_sym/d_3/> <d_un/d_sym/d_3/d_4/>'\
+' <d_un/d_sym/d_tres/> <d_un/d_sym/d_tres/d_quatro/>' \
+	d_un/**
+set --nomarkdirs
+test_glob '<d_un/d_duo/d_3/d_4> <d_un/d_duo/d_tres/d_quatro>' d_un/**/d_[4q]*
+rm d_un/d_dangling d_un/d_fifo d_un/d_file
+
 set --noglobstar
 
 # ======
@@ -995,6 +995,23 @@ then
 	exp='[one/two/three] [3] [one] [two] [three] [one/two/three] [one] [two] [three] [one] [two] [three] [one] [two] [three] '
 	[[ $got == "$exp" ]] || err_exit '$REPLY or positional parameters incorrect in filescan loop' \
 		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	printf '%s\n' 'a1 bb2 ccc3' 'p q r s t u v w x y z A B C' >foo
+	got=$(while <foo; do printf '[%s] ' "${REPLY}" "${REPLY%% *}" "${#2}" "${2#b}" "${2:1}" "${13}" "${#@}" "${@:2:2}"; echo; done)
+	exp=$'[a1 bb2 ccc3] [a1] [3] [b2] [b2] [] [3] [bb2] [ccc3] \n[p q r s t u v w x y z A B C] [p] [1] [q] [] [B] [14] [q] [r] '
+	[[ $got == "$exp" ]] || err_exit 'braced parameter expansions incorrect in filescan loop' \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	got=$(set -- x; f() { echo "$1 $#"; }; while <foo; do f y; shift; echo "$1 $#"; set -- z; echo "$1 $#"; break; done; echo "$*")
+	exp=$'y 1\nbb2 2\nz 1\nz'
+	[[ $got == "$exp" ]] || err_exit 'functions, shift or set -- wrong in filescan loop' \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	got=$(f() { while <foo; do return; done; }; f; while <foo; do echo "$1"; while <foo; do :; done; echo "$1 $REPLY"; break; done)
+	exp=$'a1\na1 a1 bb2 ccc3'
+	[[ $got == "$exp" ]] || err_exit 'nested or exited filescan loop does not restore outer loop' \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	got=$("$SHELL" -c 'function g { while <foo; do return 3; done; }; g; echo "$?"; set -- x y; echo "$1 $#"; read -r l; echo "$l"' <<<'stdin')
+	exp=$'3\nx 2\nstdin'
+	[[ $got == "$exp" ]] || err_exit "returning from a function in a filescan loop does not restore the positional parameters or standard input" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
 fi
 
 # ======
@@ -94,5 +94,120 @@ got=$(set +x; ENV=$tmp/profile "$SHELL" -i </dev/null 2>&1)
 [[ -n $got ]] && err_exit "subshell bg job in profile script prints job number (got $(printf %q "$got"))"
 fi # !SHOPT_SCRIPTONLY
 
+# ======
+# Exit statuses of many background jobs must be retrievable by PID in any order
+got=$(
+	typeset -a pid
+	for ((i=0; i<300; i++))
+	do	(exit $((i % 7))) &
+		pid[i]=$!
+	done
+	bad=0
+	for ((i=299; i>=0; i-=2))
+	do	wait ${pid[i]}
+		(($? == i % 7)) || ((bad++))
+	done
+	for ((i=0; i<300; i+=2))
+	do	wait ${pid[i]}
+		(($? == i % 7)) || ((bad++))
+	done
+	print $bad
+)
+[[ $got == 0 ]] || err_exit "wrong exit status of $got out of 300 background jobs"
+
+# ======
+# wait -n
+# each job that does not exit at once waits for a line on its own FIFO, so the order in which they finish is fixed
+# (written to with -u4, as redirecting standard output would fork the command substitution, leaving it without jobs)
+mkfifo "$tmp/wn_a" "$tmp/wn_c" || err_exit "could not create FIFOs"
+got=$(
+	(read <"$tmp/wn_a"; exit 3) & a=$!
+	(exit 1) & b=$!
+	(read <"$tmp/wn_c"; exit 2) & c=$!
+	print -u4 4>"$tmp/wn_c"
+	wait -n $a $c; print -n "$? "
+	wait -n; print -n "$? "
+	print -u4 4>"$tmp/wn_a"
+	wait -n; print -n "$? "
+	wait -n; print -n "$? "
+	wait -n $b; print "$?"
+)
+exp='2 1 3 127 127'
+[[ $got == "$exp" ]] || err_exit "wait -n: wrong exit statuses" "(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# JOBMAX must not hold up traps while waiting for a job slot
+# the job holding the only slot exits when the trap writes to its FIFO; if the trap is held up, the shell hangs
+mkfifo "$tmp/jm_slot" "$tmp/jm_ready" || err_exit "could not create FIFOs"
+"$SHELL" -c '
+	trap "print -n \"trap \"; print >\"\$1/jm_slot\"" USR1
+	JOBMAX=1
+	read <"$1/jm_slot" &
+	print >"$1/jm_ready"
+	: &
+	print done
+' jobmax "$tmp" >"$tmp/jm_out" 2>&1 &
+pid=$!
+read <"$tmp/jm_ready"
+kill -s USR1 $pid
+{ sleep 10; kill -s KILL $pid && print >"$tmp/jm_slot"; } 2>/dev/null &
+wait $pid
+kill $! 2>/dev/null
+got=$(<"$tmp/jm_out")
+[[ $got == 'trap done' ]] || err_exit "trap delayed while JOBMAX is reached" "(got $(printf %q "$got"))"
+
+# ======
+# Pipeline elements and background jobs that run an external command may be spawned
+# without forking the shell; they must behave exactly as if they were forked
+got=$("$SHELL" -c '
+	echo() { print -r -- "fn $*"; }
+	set -o pipefail
+	print -r b a | tr " " "\n" | sort | tr -d "\n"; print " $?"
+	false | tr a b; print $?
+	echo x | cat
+	sh -c "exit 3" & wait $!; print $?
+	yes | head -n 2
+' 2>/dev/null)
+exp=$'ab 0\n1\nfn x\n3\ny\ny'
+[[ $got == "$exp" ]] || err_exit "spawned pipeline elements or background jobs misbehave" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# Under 'set -m', they must get the same process groups as forked ones: a background job
+# and the first element of a pipeline lead a new process group that the other elements join
+print -r "#!$SHELL" >pgid
+cat >>pgid <<\EOF
+[[ $1 == r ]] && read -r a b
+print -r $a $b $$ $(UNIX95=1 command -p ps -o pgid= -p $$)
+EOF
+chmod +x pgid
+{ ./pgid & wait $!; ./pgid | ./pgid r; } >out
+got=$(<out)
+if	[[ $got == +([0-9])' '+([0-9])$'\n'+([0-9])' '+([0-9])' '+([0-9])' '+([0-9]) ]]
+then	set -- $got
+	((($1 == $2) && ($3 == $4) && ($4 == $6) && ($4 != $5))) || err_exit "wrong process groups for jobs under 'set -m'" \
+		"(got $(printf %q "$got"))"
+	set --
+else	warning "skipping 'set -m' process group test due to non-compliant 'ps'"
+fi
+
+# ======
+# The saved exit statuses of many reaped background jobs must all be found,
+# also in a command substitution, whose jobs are saved at another subshell level
+got=$(
+	typeset -i i st
+	typeset -a pid
+	for ((i=0; i<2000; i++))
+	do	(exit $((i % 7))) &
+		pid[i]=$!
+	done
+	for ((i=0; i<2000; i+=37))
+	do	wait ${pid[i]}
+		st=$?
+		((st == i % 7)) || print -r "job $i: wrong exit status $st"
+	done
+	print done
+)
+[[ $got == done ]] || err_exit "wrong exit status of one of many background jobs" \
+	"(got $(printf %q "$got"))"
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -74,6 +74,43 @@ if builtin cp 2> /dev/null; then
 	cp -HR "$tmp/testdir_symlink" "$tmp/result"
 	{ test -d "$tmp/result" && ! test -L "$tmp/result"; } || err_exit "'cp -HR' didn't follow the given symlink"
 	{ test -f "$tmp/result/testfile2_sym" && test -L "$tmp/result/testfile2_sym"; } || err_exit "'cp -HR' follows symlinks not given on the command line"
+
+	# cp copies the data of regular files in the kernel where it can, and falls back to
+	# read/write. Check the data for empty, large and sparse files, for overwriting a
+	# larger file and for copies to another file system, where the methods differ.
+	d=$'The quick brown fox jumps over the lazy dog.\n'
+	while ((${#d} < 1000003)); do d+=$d; done
+	print -rn -- "${d:0:1000003}" >"$tmp/cp_big"
+	print -rn -- "$d" >"$tmp/cp_big.copy"
+	unset d
+	: >"$tmp/cp_empty"
+	print -n end 1<>"$tmp/cp_sparse" 1>#((3*1024*1024))
+	for f in cp_big cp_empty cp_sparse
+	do	cp "$tmp/$f" "$tmp/$f.copy" && cmp -s "$tmp/$f" "$tmp/$f.copy" \
+		|| err_exit "cp of $f gives a different file"
+	done
+	otherfs=
+	for d in /dev/shm /run/shm
+	do	[[ -d $d && -w $d ]] && mkdir "$d/ksh93.libcmd.$$" 2>/dev/null && otherfs=$d/ksh93.libcmd.$$ && break
+	done
+	if	[[ -n $otherfs ]]
+	then	for f in cp_big cp_empty cp_sparse
+		do	cp "$tmp/$f" "$otherfs/$f" && cmp -s "$tmp/$f" "$otherfs/$f" \
+			|| err_exit "cp of $f to $otherfs gives a different file"
+		done
+		if	builtin mv 2>/dev/null
+		then	# mv copies a file when rename(2) fails with EXDEV
+			for f in cp_big cp_empty cp_sparse
+			do	cp "$tmp/$f" "$tmp/$f.mv"
+				mv "$tmp/$f.mv" "$otherfs/$f.mv" && [[ ! -e $tmp/$f.mv ]] && cmp -s "$tmp/$f" "$otherfs/$f.mv" \
+				|| err_exit "mv of $f to $otherfs fails or gives a different file"
+				mv "$otherfs/$f.mv" "$tmp/$f.mv" && [[ ! -e $otherfs/$f.mv ]] && cmp -s "$tmp/$f" "$tmp/$f.mv" \
+				|| err_exit "mv of $f from $otherfs fails or gives a different file"
+			done
+		fi
+		rm -rf "$otherfs"
+	fi
+	unset otherfs d f
 fi
 
 # ======
@@ -383,6 +420,19 @@ if builtin chmod 2>/dev/null; then
 		exp='check_verbose_mode: mode changed to 0000 (---------)'
 		[[ $got =~ "$exp" ]] || err_exit "chmod -v does not give verbose output (expected $(printf %q "$exp"), got $(printf %q "$got"))"
 
+		# A recursive absolute mode is set without stat(2)ing the files below the operand,
+		# so it must still leave symbolic links alone (and with them, the files they point to).
+		mkdir "$tmp/nostat" "$tmp/nostat/sub"
+		touch "$tmp/nostat/f" "$tmp/nostat/sub/f" "$tmp/nostat_target"
+		chmod 600 "$tmp/nostat_target"
+		ln -s ../nostat_target "$tmp/nostat/l"
+		mkfifo "$tmp/nostat/p"
+		chmod -R 0750 "$tmp/nostat"
+		chmod -R a=rX "$tmp/nostat/sub"
+		got=$(stat_perms "$tmp/nostat/f" "$tmp/nostat/p" "$tmp/nostat/sub" "$tmp/nostat/sub/f" "$tmp/nostat_target")
+		exp=$'-rwxr-x---\nprwxr-x---\ndr-xr-xr-x\n-r--r--r--\n-rw-------'
+		[[ $got == "$exp" ]] || err_exit "chmod -R with an absolute mode fails (expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
 		# Quick sanity check that the perms are as expected before being modified below.
 		exp='-rw-------'
 		got=$(stat_perms a)
@@ -583,6 +633,52 @@ if builtin cat 2> /dev/null; then
 	fi
 fi
 
+# ======
+# cat and tee move data between pipes, sockets and files in the kernel where they can.
+# Check the data where each end is a file, a pipe (FIFO) or a socket (ksh pipeline), and
+# where the reader is slow or reads in small parts so that writes are only partly done.
+if builtin cat 2>/dev/null && { builtin tee 2>/dev/null || builtin -f cmd tee 2>/dev/null; }; then
+	d=$'The quick brown fox jumps over the lazy dog.\n'
+	while ((${#d} < 3000017)); do d+=$d; done
+	print -rn -- "${d:0:3000017}" >"$tmp/splice"
+	unset d
+	cat "$tmp/splice" | cat | cat >"$tmp/splice.out"
+	cmp -s "$tmp/splice" "$tmp/splice.out" || err_exit "cat through a pipeline gives different data"
+	cat "$tmp/splice" | tee "$tmp/splice.tee" | cat >"$tmp/splice.out"
+	cmp -s "$tmp/splice" "$tmp/splice.out" || err_exit "tee in a pipeline gives different data on standard output"
+	cmp -s "$tmp/splice" "$tmp/splice.tee" || err_exit "tee in a pipeline gives different data in the file"
+	cat "$tmp/splice" | { dd bs=12345 count=1 2>/dev/null; sleep .1; cat; } >"$tmp/splice.out"
+	cmp -s "$tmp/splice" "$tmp/splice.out" || err_exit "cat to a slow reader gives different data"
+	cat "$tmp/splice" | tee "$tmp/splice.tee" | { dd bs=12345 count=1 2>/dev/null; sleep .1; cat; } >"$tmp/splice.out"
+	cmp -s "$tmp/splice" "$tmp/splice.out" || err_exit "tee to a slow reader gives different data on standard output"
+	cmp -s "$tmp/splice" "$tmp/splice.tee" || err_exit "tee to a slow reader gives different data in the file"
+	if	mkfifo "$tmp/splice.fifo" 2>/dev/null
+	then	# a file to a pipe, and a pipe to a pipeline
+		cat "$tmp/splice" >"$tmp/splice.fifo" &
+		{ sleep .1; cat; } <"$tmp/splice.fifo" >"$tmp/splice.out"
+		wait
+		cmp -s "$tmp/splice" "$tmp/splice.out" || err_exit "cat from a file to a slow pipe reader gives different data"
+		cat "$tmp/splice" >"$tmp/splice.fifo" &
+		tee "$tmp/splice.tee" <"$tmp/splice.fifo" | { dd bs=4321 count=3 2>/dev/null; sleep .1; cat; } >"$tmp/splice.out"
+		wait
+		cmp -s "$tmp/splice" "$tmp/splice.out" || err_exit "tee from a pipe to a slow reader gives different data on standard output"
+		cmp -s "$tmp/splice" "$tmp/splice.tee" || err_exit "tee from a pipe to a slow reader gives different data in the file"
+		{ cat "$tmp/splice" | cat >"$tmp/splice.fifo"; } &
+		cat <"$tmp/splice.fifo" >"$tmp/splice.out"
+		wait
+		cmp -s "$tmp/splice" "$tmp/splice.out" || err_exit "cat from a pipeline to a pipe gives different data"
+	fi
+	# with SIGPIPE ignored, tee reports the broken pipe
+	got=$("$SHELL" -c '
+		builtin tee 2>/dev/null || builtin -f cmd tee
+		trap "" PIPE
+		cat "$1" "$1" | tee /dev/null | { read -r line; }
+		wait' splice "$tmp/splice" 2>&1)
+	[[ $got == *'tee: write error'* ]] || err_exit "tee does not report a write error on a broken pipe" \
+		"(got $(printf %q "$got"))"
+	rm -f "$tmp"/splice*
+fi
+
 # ======
 # The head and tail builtins should work on files without newlines
 if builtin head 2> /dev/null; then
@@ -905,5 +1001,60 @@ if builtin getconf 2> /dev/null; then
 	[[ $exp == "$got" ]] || err_exit "'getconf -n' doesn't match names correctly" \
 		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
 fi
+# ======
+# Tests for the cksum builtin
+# Each method is run on inputs of 9, 65 and 70001 bytes, which are not multiples of
+# 8 bytes and cross the 64 and 128 byte blocks of MD5 and SHA-2, and on the largest
+# one read from a pipe. The digests were checked against other implementations.
+if builtin cksum 2>/dev/null || builtin -f cmd cksum 2>/dev/null; then
+	d=$'The quick brown fox jumps over the lazy dog.\n'
+	while ((${#d} < 70001)); do d+=$d; done
+	for n in 9 65 70001; do print -rn -- "${d:0:n}" >"$tmp/ck$n"; done
+	unset d n
+	typeset -A sums=(
+		[posix]='2956361604 2157659855 632393653'
+		[zip]='1602105444 800892250 2412311081'
+		[crc]='3111593162 846287405 3523816083'
+		[crc-rotate]='180861888 1098318208 835313696'
+		[crc-0x04c11db7-rotate]='3203182685 2456009940 591104762'
+		[att]='862 5956 41254'
+		[bsd]='10448 15018 20466'
+		[md5]='
+			912d57cea222bc1730dd531b9d6afbb6
+			45ad378bc1909ecab389e15455ad24ed
+			7f66b8948971d032338d0f3b22a2a5d7'
+		[sha1]='
+			30b59bc6c7c1622283a23950f2984bc5cd4fdd51
+			55088faa8a7de4f798cd43d30641baa9df6e0e74
+			5e8d02f9eb7796b09431e70a98f128903e0ac543'
+		[sha256]='
+			3ba62773d07dd21b5712a1c221207bf2f46e459d862e7b7062b3b9e0073bbb1e
+			8cb1316b8fa03c0ba3e24eeb2ff8a909c89bdeda90af132f91a14af7fd43d01c
+			c074d160a3c33d0fc64372f72c8fed5adff67491bfb6ab914684b1fecbdc754a'
+		[sha384]='
+			898e462929c5b044f168f28480285ae9358bef0efb4178d16b4c6881dc1fe33f4878a201caf15e6fd4a3b2a60c399177
+			a2f3a3058143f14e11fdb428705678eb5f1197fd125f3cbe47ccecbec19713b2335ad96245c7fa9ef5b3815c7e4f45b9
+			26b82faa86d6f77b303e544aec9805fea3a046d19d7df992bf8d83dfc8de97ca3677ef9d091606ebc1e2828ae523467a'
+		[sha512]='
+			bbedb9d77e386908fbce019fed3f8237b6c95b13137948844d68347116d2caf7a495a9f34af79cd762bba0190e1900afe3e922b5162ff77f265ccbd275718183
+			07b09390bf26a8213f0c7f79ef46bbfe80344ea8fcea6113f174ea9065ffed0cab5920d25db325e9cbc06a51f0955dd298f7eb36e26ea64029722c9376be6889
+			95bd8e0dac2d768dd8c2b1bf94a921a479bb63191193ae1d3b73f90bd565f08db188b2019c6aea4689d396e903908c735b45cc608f34f1ee120bfa610639d62f'
+	)
+	for m in "${!sums[@]}"
+	do	set -- ${sums[$m]}
+		exp="$* $3"
+		# run in another shell process, as 'cksum -x crc-rotate' used to crash
+		got=$(cd "$tmp" && "$SHELL" -c '
+			builtin cksum 2>/dev/null || builtin -f cmd cksum
+			{ cksum -x "$1" ck9 ck65 ck70001; cat ck70001 | cksum -x "$1"; } | while read -r sum rest
+			do	print -rn -- "$sum "
+			done' cksum "$m" 2>&1)
+		got=${got% }
+		[[ $got == "$exp" ]] || err_exit "'cksum -x $m' gives wrong digests" \
+			"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	done
+	unset sums m
+fi
+
 # ======
 exit $((Errors<125?Errors:125))
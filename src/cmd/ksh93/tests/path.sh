@@ -594,6 +594,21 @@ else	if	let "e > 0"
 	fi
 fi
 
+# ======
+# 'command -x' under job control: the final chunk was spawned with a wrong process group
+got=$(
+	set -m
+	integer i n=$(getconf ARG_MAX)/20
+	set -- $(for ((i=0; i<n; i++)); do print "${i}_command_x_argument"; done)
+	command -x "$SHELL" -c 'print $#' command_x "$@" >$tmp/command_x_m.out
+	print $? $#
+)
+integer chunks=0 args=0
+while read n; do ((chunks++, args+=n)); done <$tmp/command_x_m.out
+[[ $got == "0 $args" ]] && ((chunks > 1)) || err_exit "'command -x' under 'set -m' fails" \
+	"(got status/args $(printf %q "$got"), $args args in $chunks chunks)"
+unset chunks args
+
 # ======
 # whence -a/-v tests
 
@@ -1037,5 +1052,76 @@ got=${ type -t whence_t_test 2>&1; }
 (((e = $?) > 1)) && err_exit 'getconf builtin fails when on same path as external getconf' \
 	"(got status $e$( ((e>128)) && print -n /SIG && kill -l "$e"))"
 
+# ======
+# SHCOMP_CACHE compiled script cache
+mkdir "$tmp/shcomp_cache" "$tmp/shcomp_fun" && chmod go-w "$tmp/shcomp_cache" || err_exit "could not create directories"
+cat >$tmp/shcomp_dot.sh <<-\EOF
+	function dotfn { print -r -- "dotfn $1 $LINENO"; }
+	for i in 1 2; do dotfn "$i"; done
+	cat <<-END
+		here $i
+	END
+EOF
+print 'function cachedfn { print -r -- "cachedfn $1"; }' >$tmp/shcomp_fun/cachedfn
+exp=$'dotfn 1 1\ndotfn 2 1\nhere 2\ncachedfn x'
+for i in 1 2
+do	got=$(export SHCOMP_CACHE=$tmp/shcomp_cache; FPATH=$tmp/shcomp_fun; . "$tmp/shcomp_dot.sh"; cachedfn x 2>&1)
+	[[ $got == "$exp" ]] || err_exit "SHCOMP_CACHE run $i: wrong output" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+done
+set -- "$tmp"/shcomp_cache/*
+(($# == 2)) || err_exit "SHCOMP_CACHE: expected 2 compiled scripts, got $#"
+print 'print -r -- modified' >>$tmp/shcomp_dot.sh
+for i in 1 2
+do	got=$(export SHCOMP_CACHE=$tmp/shcomp_cache; . "$tmp/shcomp_dot.sh" 2>&1)
+	[[ $got == *$'\nmodified' ]] || err_exit "SHCOMP_CACHE: modified script not reparsed (run $i, got $(printf %q "$got"))"
+done
+print 'greet' >$tmp/shcomp_alias.sh
+got=$(export SHCOMP_CACHE=$tmp/shcomp_cache
+	alias greet='print A'; . "$tmp/shcomp_alias.sh"
+	alias greet='print B'; . "$tmp/shcomp_alias.sh" 2>&1)
+[[ $got == $'A\nB' ]] || err_exit "SHCOMP_CACHE: compiled script keeps expanded alias (got $(printf %q "$got"))"
+print 'function kwfn { print -r -- "kw=$kw args=$*"; }; kwfn kw=1' >$tmp/shcomp_kw.sh
+got=$(export SHCOMP_CACHE=$tmp/shcomp_cache; unset kw
+	. "$tmp/shcomp_kw.sh"; set -k; . "$tmp/shcomp_kw.sh" 2>&1)
+[[ $got == $'kw= args=kw=1\nkw=1 args=' ]] || err_exit "SHCOMP_CACHE: compiled script ignores keyword option (got $(printf %q "$got"))"
+
+# ======
+# Commands created or removed in cached $PATH directories must be noticed
+mkdir "$tmp/pc1" "$tmp/pc2" || err_exit "could not create directories"
+touch -t 200001010000 "$tmp/pc1" "$tmp/pc2"	# directories modified less than a second ago are not cached
+got=$(
+	PATH=$tmp/pc1:$tmp/pc2:$PATH
+	whence -p pcfoo || print none
+	print 'print pcfoo1' >$tmp/pc2/pcfoo && chmod +x "$tmp/pc2/pcfoo"
+	pcfoo
+	hash -r
+	print 'print pcfoo2' >$tmp/pc1/pcfoo && chmod +x "$tmp/pc1/pcfoo"
+	rm "$tmp/pc2/pcfoo"
+	pcfoo
+	hash -r
+	rm "$tmp/pc1/pcfoo"
+	whence -p pcfoo || print none
+)
+exp=$'none\npcfoo1\npcfoo2\nnone'
+[[ $got == "$exp" ]] || err_exit "\$PATH directory cache out of date" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# A command just added to a cached directory must be found before one of the same name later in $PATH
+mkdir "$tmp/pc3" "$tmp/pc4" || err_exit "could not create directories"
+print 'print pcbar4' >$tmp/pc4/pcbar && chmod +x "$tmp/pc4/pcbar"
+touch -t 200001010000 "$tmp/pc3" "$tmp/pc4"
+got=$("$SHELL" -c '
+	PATH=$tmp/pc3:$tmp/pc4:$PATH
+	pcbar
+	hash -r
+	print "print pcbar3" >$tmp/pc3/pcbar && chmod +x "$tmp/pc3/pcbar"
+	pcbar
+	print end
+')
+exp=$'pcbar4\npcbar3\nend'
+[[ $got == "$exp" ]] || err_exit "command added to earlier \$PATH directory not found" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -177,6 +177,38 @@ w wait
 u (Killed|Done)
 !
 
+tst $LINENO <<"!"
+L external commands in jobs get the right terminal process group
+
+# A background job that runs an external command must not get the terminal, so it
+# is stopped when it reads from it. A foreground pipeline must get the terminal.
+# These may be spawned instead of forked if posix_spawn(3) can set the terminal;
+# bgnice is turned off as a background job that needs nice(2) is always forked.
+
+d 15
+I ^\r?\n$
+p :test-1:
+w set +o bgnice
+p :test-2:
+w cat &
+u [[:digit:]]\r?\n$
+s 100
+p :test-3:
+w jobs
+u (Stopped|Suspended) \(SIGTTIN\)
+p :test-4:
+w kill -KILL %1; wait
+p :test-5:
+w cat | cat
+w foo
+u ^foo\r?\n$
+c \cZ
+u (Stopped|Suspended)
+p :test-6:
+w kill -KILL %1; wait
+u (Killed|Done)
+!
+
 tst $LINENO <<"!"
 L POSIX sh 091(C)
 
@@ -1207,5 +1207,104 @@ got=$(
 [[ $got == "$exp" ]] || err_exit "incorrect result from 'exec' in subshare in subshell" \
 	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
 
+# ======
+# Command substitution output kept in memory must survive being moved to a temporary file,
+# whether because it grows too large or because an external command writes to it
+bincat=$(whence -p cat)
+got=$(
+	integer i
+	for ((i = 0; i < 40000; i++))
+	do	print -r -- "line $i of output long enough to exceed the in-memory buffer"
+	done
+	print -r -- end | "$bincat"
+)
+exp='line 39999 of output long enough to exceed the in-memory buffer'$'\n''end'
+[[ ${got: -${#exp}} == "$exp" && ${#got} == 2548893 ]] || err_exit "large command substitution output corrupted" \
+	"(expected length 2548893 ending in $(printf %q "$exp"), got length ${#got} ending in $(printf %q "${got: -${#exp}}"))"
+got=$(TMPDIR=/dev/null/nonexistent; print -r -- one; "$bincat" <<<two; print -r -- three)
+exp=$'one\ntwo\nthree'
+[[ $got == "$exp" ]] || err_exit "command substitution output with external command out of order" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# ======
+# Changes to indexed array elements in a virtual subshell are undone element by element
+unset a
+a=(a b c d e)
+exp='typeset -a a=(a b c d e)'
+for cmd in 'a[1]=X; a[7]=Y; a[2]=Z; a[1]=W; unset a[3]' 'a[9]=q; a+=(r s)' 'a[1]=X; unset a; a[0]=n' \
+	'a[1]=X; typeset -u a; a[2]=z' 'a[1]=X; a=(p q)' '(a[0]=inner); a[0]=outer' 'set -a; a[1]=exp'
+do	eval "($cmd)"
+	got=$(typeset -p a)
+	[[ $got == "$exp" ]] || err_exit "indexed array not restored after subshell: $cmd" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+done
+exp=$'a B c d e 5\na b c e 4\nA B Z D E'
+got=$(
+	(a[1]=B; print -r -- "${a[*]} ${#a[@]}")
+	(unset a[3]; print -r -- "${a[*]} ${#a[@]}")
+	(typeset -u a; a[2]=z; print -r -- "${a[*]}")
+)
+[[ $got == "$exp" ]] || err_exit "indexed array changes in subshell not effective" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+unset a
+enum _Subshell_color_t=(red green blue)
+typeset -a [_Subshell_color_t] a
+a[blue]=test
+(a[red]=x; typeset -u a; a[green]=y)
+a[green]=z
+exp="typeset -a '[_Subshell_color_t]' a=([green]=z [blue]=test)"
+got=$(typeset -p a)
+[[ $got == "$exp" ]] || err_exit "array with enum subscripts not restored after subshell" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+unset a
+
+# ======
+# Setting a soft limit on open files with 'ulimit -S' and running a ${ subshare; } that only
+# prints should not fork a virtual subshell; the soft limit should be restored on exit
+n=$(ulimit -Sn)
+if	[[ $n == +([0-9]) ]] && ((n > 20))
+then	exp="$$ 20 $n"
+	got=$(ulimit -Sn 20; print -r -- ${.sh.pid} "$(ulimit -Sn)")
+	got+=" $(ulimit -Sn)"
+	[[ $got == "$exp" ]] || err_exit "'ulimit -Sn' in virtual subshell forks or is not restored" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+fi
+# a soft CPU time limit counts the time used by the whole shell process, so it must fork
+got=$(ulimit -St unlimited 2>/dev/null; print -r -- ${.sh.pid})
+[[ $got != "$$" ]] || err_exit "'ulimit -St' in virtual subshell does not fork"
+x=foo
+exp=$'foo\nbar '$$
+got=$(v=${ echo "$x"; print -r bar; }; print -r -- "$v ${.sh.pid}")
+[[ $got == "$exp" ]] || err_exit 'printing ${ subshare; } forks virtual subshell' \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+exp=$'sub sub\nfoo'
+got=$(v=${ x=sub; }; print -r -- "$v$x"; (v=${ (x=sub2); print ${x:=bad}; }; print -r -- "$v"))
+got=$(print -r -- $got; print -r -- "$x")
+[[ $got == "$exp" ]] || err_exit '${ subshare; } in virtual subshell wrongly scoped' \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+unset x
+# 'print' arguments that are expanded may turn out to be -f and assign a variable
+got=$("$SHELL" -c 'o=-f; x=0; ( : ${ print $o '\''abcde%n'\'' x; } ); print -r -- "$x"')
+[[ $got == 0 ]] || err_exit "'print \$o' in \${ subshare; } assigns variable in parent of virtual subshell" \
+	"(expected 0, got $(printf %q "$got"))"
+# tracked aliases added by an external command in a ${ subshare; } must not leak out
+# (without FPATH, which would make the subshare fork as the command might be autoloaded)
+if	od=$(whence -p od)
+then	got=$(unset FPATH; "$SHELL" -c 'hash -r; ( : ${ od </dev/null; } ); hash; print end')
+	got=${got%end}
+	[[ -z $got ]] || err_exit 'external command in ${ subshare; } leaks tracked alias out of virtual subshell' \
+		"(expected '', got $(printf %q "$got"))"
+fi
+if	((SHOPT_STATS))
+then	exp='5 1 1 1 1 1 0'
+	got=$("$SHELL" -c '(alias a=b); (trap : USR1); (ulimit -t unlimited); (d=${ v=1; }); (ulimit -Sn 20; d=${ print; })
+		d=$(print >/dev/null)
+		print ${.sh.stats.subforks} ${.sh.stats.subfork_alias} ${.sh.stats.subfork_signal} \
+			${.sh.stats.subfork_ulimit} ${.sh.stats.subfork_subshare} \
+			${.sh.stats.subfork_redir} ${.sh.stats.subfork_exec}' 2>&1)
+	[[ $got == "$exp" ]] || err_exit ".sh.stats subshell fork counters wrong" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+fi
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -1664,5 +1664,56 @@ done
 unset i got bound
 SRANDOM=0
 
+# ======
+# The environment list passed to external commands is cached between commands; check that it is kept up to date
+got=$(
+	e() { "$SHELL" -c 'print -r -- "${EX1-unset} ${EX2-unset} ${EX3-unset}"'; }
+	export EX1=a
+	e
+	EX1=b; e
+	export EX2=c; e
+	typeset +x EX1; e
+	function f { typeset EX2=local; e; typeset -x EX3=fn; e; }; f; e
+	unset EX2; e
+	export EX3; function EX3.get { .sh.value=dyn$((++n)); }; e; e
+)
+exp=$'a unset unset\nb unset unset\nb c unset\nunset c unset\nunset unset unset\nunset unset fn\nunset c unset\nunset unset unset\nunset unset dyn1\nunset unset dyn2'
+[[ $got == "$exp" ]] || err_exit "environment of external commands not updated" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+# only a local variable that hides an exported one changes the environment
+got=$(
+	e() { "$SHELL" -c 'print -r -- "${EX1-unset} ${EX2-unset} ${EX3-unset}"'; }
+	export EX1=a EX2=b
+	function k { typeset EX3=notexported; e; typeset EX2=local; e; unset EX2; e; }; k; e
+)
+exp=$'a b unset\na unset unset\na unset unset\na b unset'
+[[ $got == "$exp" ]] || err_exit "environment of external commands wrong with local variables" \
+	"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+
+# ======
+# .sh.profile writes wall clock and CPU time per stack and line in collapsed stack format
+if	((SHOPT_STATS))
+then	cat >prof.sh <<-\EOF
+		function inner { typeset i; for ((i=0; i<2000; i++)); do :; done; }
+		outer() { inner; }
+		.sh.profile=prof.out
+		outer
+		( inner ) &
+		wait
+		unset .sh.profile
+		inner
+	EOF
+	"$SHELL" prof.sh
+	got=$(sed 's/ [0-9]*$//' prof.out)
+	exp=$'prof.sh;outer;inner;prof.sh:1\nprof.sh;outer;prof.sh:2\nprof.sh;prof.sh:4\nprof.sh;prof.sh:5\nprof.sh;prof.sh:6\nprof.sh;prof.sh:7'
+	[[ $got == "$exp" ]] || err_exit ".sh.profile: wrong stacks" \
+		"(expected $(printf %q "$exp"), got $(printf %q "$got"))"
+	[[ -f prof.out.cpu ]] || err_exit ".sh.profile: CPU time profile not written"
+	got=$(grep -vc '^[^ ]* [1-9][0-9]*$' prof.out prof.out.cpu)
+	[[ $got == $'prof.out:0\nprof.out.cpu:0' ]] || err_exit ".sh.profile: malformed lines" "(got $(printf %q "$got"))"
+	"$SHELL" -c '.sh.profile=prof2.out; f() { exit 3; }; f'
+	[[ $? == 3 && -s prof2.out ]] || err_exit ".sh.profile not written on exit"
+fi
+
 # ======
 exit $((Errors<125?Errors:125))
@@ -0,0 +1,661 @@
+/***********************************************************************
+*                                                                      *
+*               This software is part of the ast package               *
+*            Copyright (c) 2026 Contributors to ksh 93u+m              *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*                                                                      *
+***********************************************************************/
+#include	"dthdr.h"
+
+/*	Hash table with open addressing.
+**
+**	Objects are kept in an array in traversal order. The hash table is
+**	an array of slots, each holding the hash value of an object and its
+**	position in that array, so a search only looks at the objects whose
+**	hash values match. Table sizes are powers of 2 or 3/2 times these.
+**	Slots are probed linearly in Robin Hood order. Deletion shifts the
+**	following slots back instead of leaving tombstones, and leaves a hole
+**	in the object array that is squeezed out later. The _ppos field of a
+**	link is only used while objects are moved.
+**
+**	Dtpset traverses objects in the order they were inserted.
+**	Dtopset traverses them in the order of the discipline comparison
+**	function: objects are appended unsorted and the array is sorted and
+**	merged on the first ordered operation after an insertion.
+*/
+
+#define P_MINTBL	8		/* smallest table or list size	*/
+#define P_MINSORT	8		/* insertion sort up to this	*/
+#define P_SORTBUF	64		/* sort buffer on the stack	*/
+#define P_LOAD(n)	((n) - (n)/4)	/* max #objects in n slots	*/
+#define P_HASH(h)	((h) ? (h) : 1)	/* 0 marks an empty slot	*/
+#define P_HOME(p,h)	((ssize_t)(((uint64_t)(uint)((h) * 0x9e3779b9U) * \
+				(p)->tblz) >> 32))
+#define P_NEXT(p,i)	((i)+1 < (p)->tblz ? (i)+1 : 0)
+
+#define P_OBJ(dt,l)	_DTOBJ((dt)->disc, (l))
+#define P_KEY(dt,l)	_DTKEY((dt)->disc, P_OBJ(dt,l))
+
+typedef struct _ptslot_s
+{	uint		hash;	/* hash value, 0 if the slot is empty	*/
+	uint		pos;	/* position of the object in the list	*/
+} Ptslot_t;
+
+typedef struct _ptsort_s
+{	uint64_t	pfx;	/* leading key bytes, see psort()	*/
+	Dtlink_t*	lnk;
+} Ptsort_t;
+
+typedef struct _dtprobe_s
+{	Dtdata_t	data;
+	Ptslot_t*	slot;	/* the hash table			*/
+	ssize_t		tblz;	/* size of hash table			*/
+	Dtlink_t**	list;	/* objects in traversal order		*/
+	ssize_t		lcnt;	/* #entries used in list, with holes	*/
+	ssize_t		lsiz;	/* #entries allocated for list		*/
+	ssize_t		lsrt;	/* list[0..lsrt-1] is sorted		*/
+	ssize_t		hole;	/* #deleted entries in list		*/
+	ssize_t		here;	/* list position of fingered object	*/
+} Dtprobe_t;
+
+/* distance of slot i from the home slot of hash value h */
+static ssize_t pdist(Dtprobe_t* p, uint h, ssize_t i)
+{
+	ssize_t		home = P_HOME(p,h);
+
+	return i >= home ? i - home : i + p->tblz - home;
+}
+
+/* add a slot to the hash table, which must have room for it */
+static void pinsert(Dtprobe_t* p, Ptslot_t s)
+{
+	ssize_t		i, d, e;
+	Ptslot_t	t;
+
+	for(i = P_HOME(p,s.hash), d = 0; p->slot[i].hash; i = P_NEXT(p,i), d += 1)
+	{	if((e = pdist(p,p->slot[i].hash,i)) < d) /* displace a closer object */
+		{	t = p->slot[i]; p->slot[i] = s; s = t;
+			d = e;
+		}
+	}
+	p->slot[i] = s;
+}
+
+/* make/resize hash table to hold n objects */
+static int ptable(Dt_t* dt, ssize_t n)
+{
+	Ptslot_t	*slot;
+	ssize_t		k, j, z;
+	Dtdisc_t	*disc = dt->disc;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	if(P_LOAD(p->tblz) >= n)
+		return 0;
+
+	if(p->tblz == 0 && disc->eventf) /* let user have input */
+	{	k = 0;
+		if((*disc->eventf)(dt, DT_HASHSIZE, &k, disc) > 0 && (k = k < 0 ? -k : k) > n)
+			n = k;
+	}
+
+	for(k = P_MINTBL; P_LOAD(k) < n; k = (k & (k-1)) ? k/3*4 : k/2*3)
+		;
+
+	if(!(slot = (Ptslot_t*)(*dt->memoryf)(dt, 0, k*sizeof(Ptslot_t), disc)) )
+	{	DTERROR(dt, "Error in allocating an extended hash table");
+		return -1;
+	}
+	memset(slot, 0, k*sizeof(Ptslot_t));
+
+	/* move slots into new table */
+	z = p->tblz;
+	p->tblz = k;
+	if(z > 0)
+	{	Ptslot_t	*old = p->slot;
+		p->slot = slot;
+		for(j = 0; j < z; ++j)
+			if(old[j].hash)
+				pinsert(p, old[j]);
+		(void)(*dt->memoryf)(dt, old, 0, disc);
+	}
+	else	p->slot = slot;
+
+	return 0;
+}
+
+/* find the slot of the object matching key, -1 if none */
+static ssize_t pfind(Dt_t* dt, void* key, uint h)
+{
+	ssize_t		i, d;
+	uint		s;
+	Dtdisc_t	*disc = dt->disc;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	if(p->tblz == 0)
+		return -1;
+	for(i = P_HOME(p,h), d = 0; (s = p->slot[i].hash); i = P_NEXT(p,i), d += 1)
+	{	if(s == h && _DTCMP(dt, key, P_KEY(dt,p->list[p->slot[i].pos]), disc) == 0)
+			return i;
+		if(pdist(p,s,i) < d) /* would have been placed before here */
+			break;
+	}
+
+	return -1;
+}
+
+/* remove slot i, shifting back the slots after it */
+static void pdelete(Dtprobe_t* p, ssize_t i)
+{
+	ssize_t		j;
+	uint		s;
+
+	for(j = P_NEXT(p,i); (s = p->slot[j].hash) && pdist(p,s,j) > 0;
+	    i = j, j = P_NEXT(p,j))
+		p->slot[i] = p->slot[j];
+	p->slot[i].hash = 0;
+}
+
+/* before objects move in the list, let each one remember its slot */
+static void pmark(Dtprobe_t* p)
+{
+	ssize_t		j;
+
+	for(j = 0; j < p->tblz; ++j)
+		if(p->slot[j].hash)
+			p->list[p->slot[j].pos]->_ppos = j;
+}
+
+/* after objects moved in the list, update the positions in their slots */
+static void pfix(Dtprobe_t* p)
+{
+	Dtlink_t	*l;
+	ssize_t		i;
+
+	for(i = 0; i < p->lcnt; ++i)
+		if((l = p->list[i]) )
+			p->slot[l->_ppos].pos = i;
+}
+
+/* squeeze the holes left by deleted objects out of the list */
+static void psqueeze(Dtprobe_t* p)
+{
+	Dtlink_t	*l;
+	ssize_t		i, k, srt, here;
+
+	for(i = k = srt = 0, here = -1; i < p->lcnt; ++i)
+	{	if(!(l = p->list[i]) )
+			continue;
+		if(i == p->here)
+			here = k;
+		p->list[k++] = l;
+		if(i < p->lsrt)
+			srt = k;
+	}
+	p->lcnt = k;
+	p->lsrt = srt;
+	p->here = here;
+	p->hole = 0;
+}
+
+/* make room at the end of the list */
+static int plistsize(Dt_t* dt)
+{
+	Dtlink_t	**list;
+	ssize_t		n;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	if(p->lcnt < p->lsiz)
+		return 0;
+	if(p->hole > p->lcnt/2)
+	{	pmark(p);
+		psqueeze(p);
+		pfix(p);
+		return 0;
+	}
+	n = p->lsiz ? 2*p->lsiz : P_MINTBL;
+	list = (Dtlink_t**)(*dt->memoryf)(dt, p->list, n*sizeof(Dtlink_t*), dt->disc);
+	if(!list)
+	{	DTERROR(dt, "Error in allocating an extended object list");
+		return -1;
+	}
+	p->list = list;
+	p->lsiz = n;
+	return 0;
+}
+
+/* compare two sort entries */
+#define P_SCMP(dt,a,b,disc) \
+	((a)->pfx != (b)->pfx ? ((a)->pfx < (b)->pfx ? -1 : 1) : \
+	 _DTCMP(dt, P_KEY(dt,(a)->lnk), P_KEY(dt,(b)->lnk), disc))
+
+/* merge sort */
+static void pmsort(Dt_t* dt, Ptsort_t* list, Ptsort_t* tmp, ssize_t n)
+{
+	ssize_t		m, i, j, k;
+	Ptsort_t	e;
+	Dtdisc_t	*disc = dt->disc;
+
+	if(n <= P_MINSORT) /* insertion sort */
+	{	for(i = 1; i < n; ++i)
+		{	e = list[i];
+			for(j = i; j > 0 && P_SCMP(dt, &e, &list[j-1], disc) < 0; --j)
+				list[j] = list[j-1];
+			list[j] = e;
+		}
+		return;
+	}
+	m = n/2;
+	pmsort(dt, list, tmp, m);
+	pmsort(dt, list+m, tmp, n-m);
+	if(P_SCMP(dt, &list[m-1], &list[m], disc) <= 0)
+		return; /* already in order */
+	memcpy(tmp, list, m*sizeof(Ptsort_t));
+	for(i = 0, j = m, k = 0; i < m; )
+	{	if(j < n && P_SCMP(dt, &list[j], &tmp[i], disc) < 0)
+			list[k++] = list[j++];
+		else	list[k++] = tmp[i++];
+	}
+}
+
+/* bring the list into sorted order */
+static int psort(Dt_t* dt)
+{
+	Ptsort_t	*srt, buf[P_SORTBUF + P_SORTBUF/2];
+	Dtlink_t	**list, *here;
+	uchar		*s;
+	ssize_t		n, i, j, z;
+	uint64_t	pfx;
+	Dtdisc_t	*disc = dt->disc;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	if(p->lsrt >= p->lcnt)
+		return 0;
+
+	/* the objects to sort, followed by room for the merge sort */
+	n = p->lcnt - p->lsrt;
+	if((z = n + (n+1)/2) <= (ssize_t)(sizeof(buf)/sizeof(buf[0])) )
+		srt = buf;
+	else if(!(srt = (Ptsort_t*)(*dt->memoryf)(dt, 0, z*sizeof(Ptsort_t), disc)) )
+	{	DTERROR(dt, "Error in allocating space to sort objects");
+		return -1;
+	}
+
+	here = p->here >= 0 ? p->list[p->here] : NULL;
+	pmark(p);
+	if(p->hole > 0)
+		psqueeze(p);
+	list = p->list;
+	n = p->lcnt - p->lsrt;
+
+	/* Without a comparison function, keys compare as strcmp(3) or memcmp(3) does.
+	** Then the first 8 bytes of each key, as a big-endian number, sort the keys
+	** without dereferencing them unless these bytes are equal.
+	*/
+	for(i = 0; i < n; ++i)
+	{	srt[i].lnk = list[p->lsrt+i];
+		pfx = 0;
+		if(!disc->comparf)
+		{	s = (uchar*)P_KEY(dt,srt[i].lnk);
+			for(j = 0; j < 8; ++j)
+			{	pfx <<= 8;
+				if(disc->size > 0 ? j < disc->size : *s != 0)
+					pfx |= *s++;
+			}
+		}
+		srt[i].pfx = pfx;
+	}
+	pmsort(dt, srt, srt+n, n);
+
+	/* merge from the back with the sorted part */
+	for(i = p->lsrt-1; n > 0; )
+	{	if(i >= 0 && _DTCMP(dt, P_KEY(dt,list[i]), P_KEY(dt,srt[n-1].lnk), disc) > 0)
+			list[i+n] = list[i], i -= 1;
+		else	list[i+n] = srt[n-1].lnk, n -= 1;
+	}
+	if(srt != buf)
+		(void)(*dt->memoryf)(dt, srt, 0, disc);
+
+	pfix(p);
+	p->lsrt = p->lcnt;
+	p->here = here ? (ssize_t)p->slot[here->_ppos].pos : -1;
+	return 0;
+}
+
+/* first position in a sorted list whose object is larger than key,
+** or larger than or equal to it if eq is set
+*/
+static ssize_t pbound(Dt_t* dt, void* key, int eq)
+{
+	ssize_t		lo, hi, m, k;
+	int		cmp;
+	Dtdisc_t	*disc = dt->disc;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	for(lo = 0, hi = p->lcnt; lo < hi; )
+	{	m = lo + (hi-lo)/2;
+		for(k = m; k < hi && !p->list[k]; ++k)
+			; /* skip holes */
+		if(k == hi)
+		{	hi = m;
+			continue;
+		}
+		cmp = _DTCMP(dt, key, P_KEY(dt,p->list[k]), disc);
+		if(cmp > 0 || (cmp == 0 && !eq) )
+			lo = k+1;
+		else	hi = m;
+	}
+
+	return lo;
+}
+
+/* return the object at pos or the nearest one in the direction of type */
+static void* pstep(Dt_t* dt, ssize_t pos, int type)
+{
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	if(type&(DT_NEXT|DT_FIRST|DT_ATLEAST))
+	{	for(; pos < p->lcnt; ++pos)
+			if(p->list[pos])
+				break;
+		if(pos >= p->lcnt)
+			pos = -1;
+	}
+	else
+	{	for(; pos >= 0; --pos)
+			if(p->list[pos])
+				break;
+	}
+
+	if((p->here = pos) < 0)
+		return NULL;
+	return P_OBJ(dt, p->list[pos]);
+}
+
+static void* pclear(Dt_t* dt)
+{
+	Dtlink_t	*l;
+	ssize_t		i;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	for(i = 0; i < p->lcnt; ++i)
+		if((l = p->list[i]) )
+			_dtfree(dt, l, DT_DELETE);
+
+	if(p->tblz > 0)
+		memset(p->slot, 0, p->tblz*sizeof(Ptslot_t));
+	p->lcnt = p->lsrt = p->hole = 0;
+	p->here = -1;
+	p->data.size = 0;
+
+	return NULL;
+}
+
+static void* plist(Dt_t* dt, Dtlink_t* list, int type)
+{
+	void		*obj;
+	Dtlink_t	*l, *next, *tail;
+	ssize_t		i;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	if(type&(DT_FLATTEN|DT_EXTRACT) )
+	{	if(dt->meth->type&DT_ORDERED)
+			(void)psort(dt);
+		for(list = tail = NULL, i = 0; i < p->lcnt; ++i)
+		{	if(!(l = p->list[i]) )
+				continue;
+			if(tail)
+				tail = (tail->_rght = l);
+			else	list = tail = l;
+		}
+		if(tail)
+			tail->_rght = NULL;
+
+		if(type&DT_EXTRACT)
+		{	if(p->tblz > 0)
+				memset(p->slot, 0, p->tblz*sizeof(Ptslot_t));
+			p->lcnt = p->lsrt = p->hole = 0;
+			p->here = -1;
+			p->data.size = 0;
+		}
+
+		return list;
+	}
+	else /* if(type&DT_RESTORE) */
+	{	dt->data->size = 0;
+		for(l = list; l; l = next)
+		{	next = l->_rght;
+			obj = _DTOBJ(dt->disc,l);
+			if((*dt->meth->searchf)(dt, l, DT_RELINK) == obj)
+				dt->data->size += 1;
+		}
+		return list;
+	}
+}
+
+static void* pstat(Dt_t* dt, Dtstat_t* st)
+{
+	ssize_t		i, d;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	if(st)
+	{	memset(st, 0, sizeof(Dtstat_t));
+		st->meth  = dt->meth->type;
+		st->size  = p->data.size;
+		st->space = sizeof(Dtprobe_t) + p->tblz*sizeof(Ptslot_t) +
+			    p->lsiz*sizeof(Dtlink_t*) +
+			    (dt->disc->link >= 0 ? 0 : p->data.size*sizeof(Dthold_t));
+
+		/* count objects by their distance from their home slots */
+		for(i = 0; i < p->tblz; ++i)
+		{	if(!p->slot[i].hash)
+				continue;
+			d = pdist(p,p->slot[i].hash,i);
+			if(d < DT_MAXSIZE)
+			{	st->lsize[d] += 1;
+				st->msize = d > st->msize ? d : st->msize;
+			}
+			st->mlev = d > st->mlev ? d : st->mlev;
+		}
+	}
+
+	return (void*)p->data.size;
+}
+
+static void* dtprobe(Dt_t* dt, void* obj, int type)
+{
+	Dtlink_t	*lnk, *ll;
+	void		*key, *o;
+	uint		hsh;
+	ssize_t		i, k;
+	Ptslot_t	s;
+	Dtdisc_t	*disc = dt->disc;
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+	int		ordered = dt->meth->type&DT_ORDERED;
+
+	type = DTTYPE(dt,type); /* map type for upward compatibility */
+	if(!(type&DT_OPERATIONS) )
+		return NULL;
+
+	DTSETLOCK(dt);
+
+	if(type&(DT_FIRST|DT_LAST|DT_CLEAR|DT_EXTRACT|DT_RESTORE|DT_FLATTEN|DT_STAT) )
+	{	if(type&(DT_FIRST|DT_LAST) )
+		{	if(ordered && psort(dt) < 0)
+				DTRETURN(obj, NULL);
+			DTRETURN(obj, pstep(dt, (type&DT_FIRST) ? 0 : p->lcnt-1, type));
+		}
+		else if(type&DT_CLEAR)
+			DTRETURN(obj, pclear(dt));
+		else if(type&DT_STAT)
+			DTRETURN(obj, pstat(dt, (Dtstat_t*)obj));
+		else /*if(type&(DT_EXTRACT|DT_RESTORE|DT_FLATTEN))*/
+			DTRETURN(obj, plist(dt, (Dtlink_t*)obj, type));
+	}
+
+	if(!obj) /* from here on, an object prototype is required */
+		DTRETURN(obj, NULL);
+
+	/* fingered object */
+	if((type&(DT_SEARCH|DT_NEXT|DT_PREV)) && p->here >= 0 &&
+	   (lnk = p->list[p->here]) && obj == _DTOBJ(disc,lnk) )
+	{	if(type&DT_SEARCH)
+			DTRETURN(obj, obj);
+		if(ordered && psort(dt) < 0)
+			DTRETURN(obj, NULL);
+		DTRETURN(obj, pstep(dt, (type&DT_NEXT) ? p->here+1 : p->here-1, type));
+	}
+
+	if(type&DT_RELINK)
+	{	lnk = (Dtlink_t*)obj;
+		obj = _DTOBJ(disc,lnk);
+		key = _DTKEY(disc,obj);
+	}
+	else
+	{	lnk = NULL;
+		if(type&DT_MATCH)
+		{	key = obj;
+			obj = NULL;
+		}
+		else	key = _DTKEY(disc,obj);
+	}
+	hsh = _DTHSH(dt,key,disc);
+	hsh = P_HASH(hsh);
+
+	if((i = pfind(dt, key, hsh)) >= 0) /* found object */
+	{	k = p->slot[i].pos;
+		ll = p->list[k];
+		o = _DTOBJ(disc,ll);
+		if(type&(DT_SEARCH|DT_MATCH|DT_ATLEAST|DT_ATMOST) )
+		{	p->here = k;
+			DTRETURN(obj, o);
+		}
+		else if(type&(DT_NEXT|DT_PREV) )
+		{	if(ordered && psort(dt) < 0) /* sorting moves objects but not slots */
+				DTRETURN(obj, NULL);
+			k = p->slot[i].pos;
+			DTRETURN(obj, pstep(dt, (type&DT_NEXT) ? k+1 : k-1, type));
+		}
+		else if(type&(DT_DELETE|DT_DETACH|DT_REMOVE) )
+		{	if((type&DT_REMOVE) && o != obj)
+				DTRETURN(obj, NULL);
+			pdelete(p, i);
+			p->list[k] = NULL;
+			p->hole += 1;
+			if(p->here == k)
+				p->here = -1;
+			p->data.size -= 1;
+			_dtfree(dt, ll, type);
+			DTRETURN(obj, o);
+		}
+		else if(type&DT_INSTALL)
+		{	if(!(lnk = _dtmake(dt, obj, type)) )
+				DTRETURN(obj, NULL);
+			/* the new object takes the place of the old one */
+			p->list[k] = lnk;
+			p->here = k;
+			_dtfree(dt, ll, DT_DELETE);
+			DTANNOUNCE(dt, o, DT_DELETE);
+			DTRETURN(obj, _DTOBJ(disc,lnk));
+		}
+		else
+		{	/**/DEBUG_ASSERT(type&(DT_INSERT|DT_ATTACH|DT_APPEND|DT_RELINK));
+			if(type&(DT_INSERT|DT_APPEND|DT_ATTACH) )
+				type |= DT_MATCH; /* for announcement */
+			else if(lnk && (type&DT_RELINK) )
+			{	/* remove a duplicate */
+				obj = _DTOBJ(disc, lnk);
+				_dtfree(dt, lnk, DT_DELETE);
+				DTANNOUNCE(dt, obj, DT_DELETE);
+			}
+			p->here = k;
+			DTRETURN(obj, o);
+		}
+	}
+	else /* no matching object */
+	{	if(type&(DT_NEXT|DT_PREV|DT_ATLEAST|DT_ATMOST) )
+		{	/* only ordered sets know the neighbors of a missing key */
+			if(!ordered || psort(dt) < 0)
+				DTRETURN(obj, NULL);
+			i = pbound(dt, key, (type&(DT_PREV|DT_ATLEAST)) ? 1 : 0);
+			DTRETURN(obj, pstep(dt, (type&(DT_NEXT|DT_ATLEAST)) ? i : i-1, type));
+		}
+		if(!(type&(DT_INSERT|DT_INSTALL|DT_APPEND|DT_ATTACH|DT_RELINK)) )
+			DTRETURN(obj, NULL);
+
+		if(ptable(dt, p->data.size+1) < 0 || plistsize(dt) < 0)
+			DTRETURN(obj, NULL);
+		if(!lnk) /* inserting a new object */
+		{	if(!(lnk = _dtmake(dt, obj, type)) )
+				DTRETURN(obj, NULL);
+			p->data.size += 1;
+		}
+		s.hash = hsh;
+		s.pos = p->lcnt;
+		pinsert(p, s);
+
+		/* an object added after the largest one keeps the list sorted */
+		if(ordered && p->lsrt == p->lcnt && (p->lcnt == 0 ||
+		   ((ll = p->list[p->lcnt-1]) && _DTCMP(dt, key, P_KEY(dt,ll), disc) > 0)) )
+			p->lsrt += 1;
+		p->here = p->lcnt;
+		p->list[p->lcnt++] = lnk;
+
+		DTRETURN(obj, _DTOBJ(disc,lnk));
+	}
+
+dt_return:
+	DTANNOUNCE(dt, obj, type);
+	DTCLRLOCK(dt);
+	return obj;
+}
+
+static int probeevent(Dt_t* dt, int event, void* arg)
+{
+	Dtprobe_t	*p = (Dtprobe_t*)dt->data;
+
+	NOT_USED(arg);
+	if(event == DT_OPEN)
+	{	if(p)
+			return 0;
+		if(!(p = (Dtprobe_t*)(*dt->memoryf)(dt, 0, sizeof(Dtprobe_t), dt->disc)) )
+		{	DTERROR(dt, "Error in allocating a hash table with open addressing");
+			return -1;
+		}
+		memset(p, 0, sizeof(Dtprobe_t));
+		p->here = -1;
+		dt->data = (Dtdata_t*)p;
+		return 1;
+	}
+	else if(event == DT_CLOSE)
+	{	if(!p)
+			return 0;
+		if(p->data.size > 0)
+			(void)pclear(dt);
+		if(p->slot)
+			(void)(*dt->memoryf)(dt, p->slot, 0, dt->disc);
+		if(p->list)
+			(void)(*dt->memoryf)(dt, p->list, 0, dt->disc);
+		(void)(*dt->memoryf)(dt, p, 0, dt->disc);
+		dt->data = NULL;
+		return 0;
+	}
+	else	return 0;
+}
+
+static Dtmethod_t	_Dtpset = { dtprobe, DT_SET, probeevent, "Dtpset",
+				"open addressing hash table, insertion order" };
+static Dtmethod_t	_Dtopset = { dtprobe, DT_OSET, probeevent, "Dtopset",
+				"open addressing hash table, sorted order" };
+Dtmethod_t		*Dtpset = &_Dtpset;
+Dtmethod_t		*Dtopset = &_Dtopset;
+
+#ifdef NoF
+NoF(dtprobe)
+#endif
@@ -229,6 +229,8 @@ extern Dtmethod_t* 	Dtset;
 extern Dtmethod_t* 	Dtbag;
 extern Dtmethod_t* 	Dtoset;
 extern Dtmethod_t* 	Dtobag;
+extern Dtmethod_t* 	Dtpset;
+extern Dtmethod_t* 	Dtopset;
 extern Dtmethod_t*	Dtlist;
 extern Dtmethod_t*	Dtstack;
 extern Dtmethod_t*	Dtqueue;
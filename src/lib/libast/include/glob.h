@@ -121,6 +121,7 @@ struct _glob_
 
 /* gl_status */
 #define GLOB_NOTDIR	0x0001		/* last gl_dirnext() not a dir	*/
+#define GLOB_ISDIR	0x0002		/* last gl_dirnext() a dir	*/
 
 /* gl_type return */
 #define GLOB_NOTFOUND	0		/* does not exist		*/
@@ -105,6 +105,11 @@ typedef int (*Stat_f)(const char*, struct stat*);
 #ifdef D_TYPE
 #define ISTYPE(f,t)	((f)->type == (t))
 #define TYPE(f,t)	((f)->type = (t))
+#ifdef DTTOIF
+#define MODE(f)		((f)->type == DT_UNKNOWN ? 0 : DTTOIF((f)->type))
+#else
+#define MODE(f)		((f)->type == DT_REG ? S_IFREG : (f)->type == DT_DIR ? S_IFDIR : (f)->type == DT_LNK ? S_IFLNK : 0)
+#endif
 #define SKIP(p,f)	((f)->fts_parent->must == 0 && (((f)->type == DT_UNKNOWN) ? SKIPLINK(p,f) : ((f)->type != DT_DIR && ((f)->type != DT_LNK || ((p)->flags & FTS_PHYSICAL)))))
 #else
 #undef	DT_UNKNOWN
@@ -113,6 +118,7 @@ typedef int (*Stat_f)(const char*, struct stat*);
 #define DT_LNK		1
 #define ISTYPE(f,t)	((t)==DT_UNKNOWN)
 #define TYPE(f,d)
+#define MODE(f)		0
 #define SKIP(p,f)	((f)->fts_parent->must == 0 && SKIPLINK(p,f))
 #endif
 
@@ -132,6 +138,10 @@ typedef int (*Stat_f)(const char*, struct stat*);
  *	D_TYPE(&dirent_t)!=DT_UNKNOWN
  *	    OR
  *	st_nlink>=2
+ *
+ * the st_mode of an FTS_NSOK entry has the file type from the
+ * directory entry, or 0 if it did not give one; the rest of its
+ * stat info is undefined
  */
 
 #define FTS_children_resume	1
@@ -1064,7 +1074,11 @@ fts_read(FTS* fts)
 					f->fts_info = FTS_DOT;
 				}
 				else if ((fts->nostat || SKIP(fts, f)) && (f->fts_info = FTS_NSOK) || info(fts, f, s, &f->statb, fts->flags))
+				{
 					f->statb.st_ino = D_FILENO(d);
+					if (f->fts_info == FTS_NSOK)
+						f->statb.st_mode = MODE(f);
+				}
 				if (fts->comparf)
 					fts->root = search(f, fts->root, fts->comparf, 1);
 				else if (fts->children || f->fts_info == FTS_D || f->fts_info == FTS_SL)
@@ -44,6 +44,7 @@
 #define MATCH_RAW	1
 #define MATCH_MAKE	2
 #define MATCH_META	4
+#define MATCH_DIR	8
 
 #define MATCHPATH(g)	(offsetof(globlist_t,gl_path)+(g)->gl_extra)
 
@@ -97,7 +98,9 @@ gl_dirnext(glob_t* gp, void* handle)
 	while (dp = (struct dirent*)(*gp->gl_readdir)(handle))
 	{
 #ifdef D_TYPE
-		if (D_TYPE(dp) != DT_UNKNOWN && D_TYPE(dp) != DT_DIR && D_TYPE(dp) != DT_LNK)
+		if (D_TYPE(dp) == DT_DIR)
+			gp->gl_status |= GLOB_ISDIR;
+		else if (D_TYPE(dp) != DT_UNKNOWN && D_TYPE(dp) != DT_LNK)
 			gp->gl_status |= GLOB_NOTDIR;
 #endif
 		return dp->d_name;
@@ -232,8 +235,13 @@ trim(char* sp, char* p1, int* n1, char* p2, int* n2)
 	} while (*dp++ = c);
 }
 
+/*
+ * <status> has the GLOB_ISDIR and GLOB_NOTDIR bits that gl_dirnext() set
+ * for <pat>, if any; gl_type() is only called if these do not tell enough
+ */
+
 static void
-addmatch(glob_t* gp, const char* dir, const char* pat, const char* rescan, char* endslash, int meta)
+addmatch(glob_t* gp, const char* dir, const char* pat, const char* rescan, char* endslash, int meta, unsigned long status)
 {
 	globlist_t*	ap;
 	int		offset;
@@ -250,7 +258,7 @@ addmatch(glob_t* gp, const char* dir, const char* pat, const char* rescan, char*
 	sfputr(globstk,pat,-1);
 	if (rescan)
 	{
-		if ((*gp->gl_type)(gp, stkptr(globstk,MATCHPATH(gp)), 0) != GLOB_DIR)
+		if (!(status & GLOB_ISDIR) && (*gp->gl_type)(gp, stkptr(globstk,MATCHPATH(gp)), 0) != GLOB_DIR)
 			return;
 		sfputc(globstk,gp->gl_delim);
 		offset = stktell(globstk);
@@ -268,7 +276,8 @@ addmatch(glob_t* gp, const char* dir, const char* pat, const char* rescan, char*
 	}
 	else
 	{
-		if (!endslash && (gp->gl_flags & GLOB_MARK) && (type = (*gp->gl_type)(gp, stkptr(globstk,MATCHPATH(gp)), 0)))
+		if (!endslash && (gp->gl_flags & GLOB_MARK) && !((status & GLOB_NOTDIR) && !(gp->gl_flags & GLOB_COMPLETE))
+		&& (type = (status & GLOB_ISDIR) ? GLOB_DIR : (*gp->gl_type)(gp, stkptr(globstk,MATCHPATH(gp)), 0)))
 		{
 			if ((gp->gl_flags & GLOB_COMPLETE) && type != GLOB_EXE)
 			{
@@ -284,6 +293,9 @@ addmatch(glob_t* gp, const char* dir, const char* pat, const char* rescan, char*
 		gp->gl_pathc++;
 	}
 	ap->gl_flags = MATCH_RAW|meta;
+	/* a directory to rescan that need not be checked again */
+	if (rescan && (status & GLOB_ISDIR))
+		ap->gl_flags |= MATCH_DIR;
 	if (gp->gl_flags & GLOB_COMPLETE)
 		ap->gl_flags |= MATCH_MAKE;
 }
@@ -309,6 +321,7 @@ glob_dir(glob_t* gp, globlist_t* ap, int re_flags)
 	regex_t*	pre;
 	regex_t		rec;
 	regex_t		rei;
+	unsigned long	status;
 	int		notdir;
 	int		t1;
 	int		t2;
@@ -326,6 +339,7 @@ glob_dir(glob_t* gp, globlist_t* ap, int re_flags)
 	regex_t*	prei = 0;
 	char*		matchdir = 0;
 	int		starstar = 0;
+	int		known = 0;
 
 	if (*gp->gl_intr)
 	{
@@ -358,10 +372,10 @@ again:
 				c = (*gp->gl_type)(gp, prefix, 0);
 				*(rescan - 2) = gp->gl_delim;
 				if (c == GLOB_DIR)
-					addmatch(gp, NULL, prefix, NULL, rescan - 1, anymeta);
+					addmatch(gp, NULL, prefix, NULL, rescan - 1, anymeta, 0);
 			}
 			else if ((anymeta || !(gp->gl_flags & GLOB_NOCHECK)) && (*gp->gl_type)(gp, prefix, 0))
-				addmatch(gp, NULL, prefix, NULL, NULL, anymeta);
+				addmatch(gp, NULL, prefix, NULL, NULL, anymeta, 0);
 			return;
 		case '[':
 			if (!bracket)
@@ -408,6 +422,8 @@ again:
 	anymeta |= meta;
 	if (matchdir)
 		goto skip;
+	/* the directory to read is the one addmatch() found in a directory entry */
+	known = (ap->gl_flags & MATCH_DIR) && pat == ap->gl_begin;
 	if (pat == prefix)
 	{
 		prefix = 0;
@@ -488,7 +504,7 @@ skip:
 				break;
 			prefix = streq(dirname, ".") ? NULL : dirname;
 		}
-		if ((!starstar && !gp->gl_starstar || (t1 = (*gp->gl_type)(gp, dirname, GLOB_STARSTAR)) == GLOB_DIR
+		if ((!starstar && !gp->gl_starstar || known || (t1 = (*gp->gl_type)(gp, dirname, GLOB_STARSTAR)) == GLOB_DIR
 			|| t1 == GLOB_SYM && pat[0]=='*' && pat[1]=='\0') /* follow symlinks to dirs for non-globstar components */
 		&& (dirf = (*gp->gl_diropen)(gp, dirname)))
 		{
@@ -549,22 +565,23 @@ skip:
 				 * final element in the pattern (i.e., if 'pat' does not contain a slash) and is not specified
 				 * literally as '.' or '..', i.e. only if '.' or '..' was actually resolved from a glob pattern.
 				 */
+				status = gp->gl_status & (GLOB_NOTDIR|GLOB_ISDIR);
+				gp->gl_status &= ~(GLOB_NOTDIR|GLOB_ISDIR);
+				notdir = status & GLOB_NOTDIR;
 				if (!(matchdir && (pat[0] == '.' && (!pat[1] || pat[1] == '.' && !pat[2]) || strchr(pat,'/')))
 				&& name[0] == '.' && (!name[1] || name[1] == '.' && !name[2])
 				&& !(gp->gl_flags & GLOB_FCOMPLETE))
 					continue;
-				if (notdir = (gp->gl_status & GLOB_NOTDIR))
-					gp->gl_status &= ~GLOB_NOTDIR;
 				if (ire && !regexec(ire, name, 0, NULL, 0))
 					continue;
 				if (matchdir && (name[0] != '.' || name[1] && (name[1] != '.' || name[2])) && !notdir)
-					addmatch(gp, prefix, name, matchdir, NULL, anymeta);
+					addmatch(gp, prefix, name, matchdir, NULL, anymeta, status);
 				if (!regexec(pre, name, 0, NULL, 0))
 				{
 					if (!rescan || !notdir)
-						addmatch(gp, prefix, name, rescan, NULL, anymeta);
+						addmatch(gp, prefix, name, rescan, NULL, anymeta, status);
 					if (starstar==1 || (starstar==2 && !notdir))
-						addmatch(gp, prefix, name, starstar==2?"":NULL, NULL, anymeta);
+						addmatch(gp, prefix, name, starstar==2?"":NULL, NULL, anymeta, status);
 				}
 				errno = 0;
 			}
@@ -27,10 +27,9 @@
 #include <regex.h>
 
 #define CACHE		8		/* default # cached re's	*/
+#define CACHE_MAX	128		/* cache grows up to this size	*/
 #define ROUND		64		/* pattern buffer size round	*/
 
-typedef unsigned long Key_t;
-
 typedef struct Cache_s
 {
 	char*		pattern;
@@ -39,14 +38,19 @@ typedef struct Cache_s
 	regflags_t	reflags;
 	int		keep;
 	int		size;
+	unsigned int	hash;
+	struct Cache_s*	next;		/* hash chain of kept re's	*/
 } Cache_t;
 
 typedef struct State_s
 {
 	unsigned int	size;
+	unsigned int	limit;
+	unsigned int	mask;
 	unsigned long	serial;
 	char*		locale;
 	Cache_t**	cache;
+	Cache_t**	table;		/* hash table, mask+1 chains	*/
 } State_t;
 
 static State_t	matchstate;
@@ -66,6 +70,63 @@ flushcache(void)
 			matchstate.cache[i]->keep = 0;
 			regfree(&matchstate.cache[i]->re);
 		}
+	if (matchstate.table)
+		memset(matchstate.table, 0, (matchstate.mask + 1) * sizeof(Cache_t*));
+}
+
+/*
+ * remove a kept re from its hash chain
+ */
+
+static void
+unhash(Cache_t* cp)
+{
+	Cache_t**	pp;
+
+	for (pp = &matchstate.table[cp->hash & matchstate.mask]; *pp; pp = &(*pp)->next)
+		if (*pp == cp)
+		{
+			*pp = cp->next;
+			break;
+		}
+}
+
+/*
+ * resize the cache to n entries and rebuild the hash table
+ * 0 returned on success
+ */
+
+static int
+resize(unsigned int n)
+{
+	Cache_t**	cache;
+	Cache_t**	table;
+	Cache_t*	cp;
+	unsigned int	m;
+	int		i;
+
+	if (!(cache = newof(matchstate.cache, Cache_t*, n, 0)))
+		return -1;
+	if (n > matchstate.size)
+		memset(cache + matchstate.size, 0, (n - matchstate.size) * sizeof(Cache_t*));
+	matchstate.cache = cache;
+	matchstate.size = n;
+	for (m = 1; m < 2 * n; m <<= 1);
+	if (m - 1 != matchstate.mask || !matchstate.table)
+	{
+		if (!(table = newof(0, Cache_t*, m, 0)))
+			return -1;
+		free(matchstate.table);
+		matchstate.table = table;
+		matchstate.mask = m - 1;
+		for (i = 0; i < n; i++)
+			if ((cp = cache[i]) && cp->keep)
+			{
+				cp->next = table[cp->hash & matchstate.mask];
+				table[cp->hash & matchstate.mask] = cp;
+			}
+	}
+	return 0;
 }
 
 /*
@@ -81,7 +142,7 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 	int		empty;
 	int		unused;
 	int		old;
-	Key_t		key;
+	unsigned int	hash;
 
 	/*
 	 * 0 pattern flushes the cache and reflags>0 extends cache
@@ -93,13 +154,10 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 		i = 0;
 		if (reflags > matchstate.size)
 		{
-			if (matchstate.cache = newof(matchstate.cache, Cache_t*, reflags, 0))
-				matchstate.size = reflags;
-			else
-			{
-				matchstate.size = 0;
+			if (resize(reflags))
 				i = 1;
-			}
+			else if (reflags > matchstate.limit)
+				matchstate.limit = reflags;
 		}
 		if (status)
 			*status = i;
@@ -107,9 +165,9 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 	}
 	if (!matchstate.cache)
 	{
-		if (!(matchstate.cache = newof(0, Cache_t*, CACHE, 0)))
+		if (resize(CACHE))
 			return NULL;
-		matchstate.size = CACHE;
+		matchstate.limit = CACHE_MAX;
 	}
 
 	/*
@@ -128,25 +186,35 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 	 * check if the pattern is in the cache
 	 */
 
-	for (i = 0; i < sizeof(key) && pattern[i]; i++)
-		((char*)&key)[i] = pattern[i];
-	for (; i < sizeof(key); i++)
-		((char*)&key)[i] = 0;
-	empty = unused = -1;
-	old = 0;
-	for (i = matchstate.size; i--;)
-		if (!matchstate.cache[i])
-			empty = i;
-		else if (!matchstate.cache[i]->keep)
-			unused = i;
-		else if (*(Key_t*)matchstate.cache[i]->pattern == key && !strcmp(matchstate.cache[i]->pattern, pattern) && matchstate.cache[i]->reflags == reflags)
+	hash = strhash(pattern) ^ (unsigned int)reflags;
+	for (cp = matchstate.table[hash & matchstate.mask]; cp; cp = cp->next)
+		if (cp->hash == hash && cp->reflags == reflags && !strcmp(cp->pattern, pattern))
 			break;
-		else if (!matchstate.cache[old] || matchstate.cache[old]->serial > matchstate.cache[i]->serial)
-			old = i;
-	if (i < 0)
+	if (!cp)
 	{
+		/*
+		 * use an empty or unused entry, else grow the
+		 * cache up to its limit before evicting the
+		 * least recently used re
+		 */
+
+		empty = unused = -1;
+		old = 0;
+		for (i = matchstate.size; i--;)
+			if (!matchstate.cache[i])
+				empty = i;
+			else if (!matchstate.cache[i]->keep)
+				unused = i;
+			else if (!matchstate.cache[old] || matchstate.cache[old]->serial > matchstate.cache[i]->serial)
+				old = i;
 		if (unused < 0)
 		{
+			if (empty < 0 && matchstate.size < matchstate.limit)
+			{
+				i = matchstate.size;
+				if (!resize(matchstate.size * 2 < matchstate.limit ? matchstate.size * 2 : matchstate.limit))
+					empty = i;
+			}
 			if (empty < 0)
 				unused = old;
 			else
@@ -160,6 +228,7 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 		}
 		if (cp->keep)
 		{
+			unhash(cp);
 			cp->keep = 0;
 			regfree(&cp->re);
 		}
@@ -174,8 +243,6 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 			}
 		}
 		strcpy(cp->pattern, pattern);
-		while (++i < sizeof(Key_t))
-			cp->pattern[i] = 0;
 		pattern = (const char*)cp->pattern;
 		if (i = regcomp(&cp->re, pattern, reflags))
 		{
@@ -185,9 +252,10 @@ regcache(const char* pattern, regflags_t reflags, int* status)
 		}
 		cp->keep = 1;
 		cp->reflags = reflags;
+		cp->hash = hash;
+		cp->next = matchstate.table[hash & matchstate.mask];
+		matchstate.table[hash & matchstate.mask] = cp;
 	}
-	else
-		cp = matchstate.cache[i];
 	cp->serial = ++matchstate.serial;
 	if (status)
 		*status = 0;
@@ -18,6 +18,9 @@
 *                                                                      *
 ***********************************************************************/
 #include	"sfhdr.h"
+#if _lib_memfd_create
+#  include <sys/mman.h>
+#endif
 #if defined(__linux__) && _lib_statfs
 #  include <sys/statfs.h>
 #  ifndef  TMPFS_MAGIC
@@ -131,6 +134,15 @@ static int _tmpfd(Sfio_t* f)
 	char*	file;
 	int	fd;
 
+#if _lib_memfd_create
+	/*
+	 * An anonymous memory file has no name in any file system,
+	 * so it needs neither a writable temporary directory nor removal
+	 */
+	if((fd = memfd_create("sftmp", 0)) >= 0)
+		return fd;
+#endif
+
 #if defined(__linux__) && _lib_statfs
 	/*
 	 * Use the area of POSIX shared memory objects for the new temporary file descriptor
@@ -26,6 +26,9 @@
 
 #include <cmd.h>
 #include <fcntl.h>
+#include <copy.h>
+
+#include "FEATURE/copy"
 
 static const char usage[] =
 "[-?\n@(#)$Id: cat (ksh 93u+m) 2022-08-30 $\n]"
@@ -113,6 +116,96 @@ regress(Sfio_t* sp, ssize_t n, int f)
 	return r;
 }
 
+/*
+ * copy <ip> to the pipe or socket <op> with splice(2), which moves the data
+ * without copying it through user space
+ * splice(2) does not wait for input; an sfio read does that instead, so that
+ * the shell's read discipline can act on a signal that arrived meanwhile
+ * -1 is returned on error, 0 at end of file, and 1 if the caller must copy
+ * the rest because splice cannot be used
+ */
+
+static int
+splicecat(Sfio_t* ip, Sfio_t* op, Shbltin_t* context)
+{
+#if _lib_splice
+	struct stat	st;
+	ssize_t		n;
+	char*		buf;
+	int		ifd = sffileno(ip);
+	int		ofd = sffileno(op);
+	int		p[2];
+	int		moved = 0;
+	int		flags = SPLICE_F_MOVE|SPLICE_F_NONBLOCK;
+	int		opipe;
+	int		r;
+
+	if (fstat(ofd, &st) || !S_ISFIFO(st.st_mode) && !S_ISSOCK(st.st_mode))
+		return 1;
+	opipe = S_ISFIFO(st.st_mode);
+	if (fstat(ifd, &st))
+		return 1;
+	/* a regular standard input must stay in sync with its sfio stream */
+	if (!S_ISFIFO(st.st_mode) && !S_ISSOCK(st.st_mode) && (ip == sfstdin || !S_ISREG(st.st_mode)))
+		return 1;
+	if (sfreserve(ip, 0, -1) || sfsync(op))
+		return 1;
+	/* one end must be a pipe, so go through a private one if neither is */
+	if (S_ISFIFO(st.st_mode) || opipe)
+		p[0] = p[1] = -1;
+	else if (pipe(p))
+		return 1;
+	/* a regular file is never waited for, so wait for room in the output pipe */
+	if (S_ISREG(st.st_mode))
+		flags &= ~SPLICE_F_NONBLOCK;
+	for (;;)
+	{
+		if ((n = splice(ifd, NULL, p[1] < 0 ? ofd : p[1], NULL, SPLICE_CHUNK, flags)) > 0)
+		{
+			moved = 1;
+			if (p[0] >= 0 && splice_move(p[0], ofd, n, context) != n)
+			{
+				r = -1;
+				break;
+			}
+		}
+		else if (!n)
+		{
+			r = 0;
+			break;
+		}
+		else if (errno == EAGAIN)
+		{
+			if (!(buf = sfreserve(ip, SFIO_UNBOUND, 0)))
+			{
+				r = sfeof(ip) && !sferror(ip) ? 0 : -1;
+				break;
+			}
+			n = sfvalue(ip);
+			if (sfwrite(op, buf, n) != n || sfsync(op))
+			{
+				r = -1;
+				break;
+			}
+			moved = 1;
+		}
+		else if (errno != EINTR || sh_checksig(context))
+		{
+			r = moved || errno != EINVAL && errno != ENOSYS ? -1 : 1;
+			break;
+		}
+	}
+	if (p[0] >= 0)
+	{
+		close(p[0]);
+		close(p[1]);
+	}
+	return r;
+#else
+	return 1;
+#endif
+}
+
 /*
  * called for any special output processing
  */
@@ -533,10 +626,13 @@ b_cat(int argc, char** argv, Shbltin_t* context)
 			sfsetbuf(fp, fp, -1);
 		if (dovcat)
 			n = vcat(states, fp, sfstdout, reserve, flags);
-		else if (sfmove(fp, sfstdout, SFIO_UNBOUND, -1) >= 0 && sfeof(fp))
-			n = 0;
-		else
-			n = -1;
+		else if ((n = splicecat(fp, sfstdout, context)) > 0)
+		{
+			if (sfmove(fp, sfstdout, SFIO_UNBOUND, -1) >= 0 && sfeof(fp))
+				n = 0;
+			else
+				n = -1;
+		}
 		if (fp != sfstdin)
 			sfclose(fp);
 		if (n < 0 && !ERROR_PIPE(errno) && errno != EINTR)
@@ -251,6 +251,14 @@ b_chmod(int argc, char** argv, Shbltin_t* context)
 			UNREACHABLE();
 		}
 	}
+
+	/*
+	 * in a physical walk, files below the operands need not be stat()ed
+	 * if the new mode does not depend on the old one and -c does not need it
+	 */
+
+	if (!(flags & FTS_TOP) && (flags & FTS_PHYSICAL) && notify != 1 && (!amode || !((strperm(amode, &last, 0) ^ strperm(amode, &last, S_IPERM)) & S_IPERM)))
+		flags |= FTS_NOSTAT;
 	if (!(fts = fts_open(argv, flags, NULL)))
 	{
 		if (ignore)
@@ -261,6 +269,13 @@ b_chmod(int argc, char** argv, Shbltin_t* context)
 	while (!sh_checksig(context) && (ent = fts_read(fts)))
 		switch (ent->fts_info)
 		{
+		case FTS_NSOK:
+			/* not stat()ed; the directory entry may have given the file type */
+			if (!(ent->fts_statp->st_mode & S_IFMT) && lstat(ent->fts_accpath, ent->fts_statp))
+				goto nostat;
+			if (!S_ISLNK(ent->fts_statp->st_mode))
+				goto anyway;
+			/* FALLTHROUGH */
 		case FTS_SL:
 		case FTS_SLNONE:
 			if (chlink)
@@ -307,6 +322,7 @@ b_chmod(int argc, char** argv, Shbltin_t* context)
 				error(ERROR_system(0), "%s: cannot search directory", ent->fts_path);
 			goto anyway;
 		case FTS_NS:
+		nostat:
 			if (!force)
 				error(ERROR_system(0), "%s: not found", ent->fts_path);
 			break;
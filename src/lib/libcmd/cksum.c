@@ -561,6 +561,14 @@ b_cksum(int argc, char** argv, Shbltin_t* context)
 		flags &= ~(FTS_META|FTS_PHYSICAL);
 		flags |= FTS_SEEDOTDIR;
 	}
+
+	/*
+	 * in a physical walk, files below the operands need not be
+	 * stat()ed unless --permissions needs their status
+	 */
+
+	if (state.recursive && (flags & FTS_PHYSICAL) && !state.permissions)
+		flags |= FTS_NOSTAT;
 	if (state.permissions)
 	{
 		state.uid = geteuid();
@@ -606,6 +614,16 @@ b_cksum(int argc, char** argv, Shbltin_t* context)
 				if (!(flags & FTS_PHYSICAL) || (flags & FTS_META) && ent->fts_level == 1)
 					fts_set(NULL, ent, FTS_FOLLOW);
 				break;
+			case FTS_NSOK:
+				/* not stat()ed; the directory entry may have given the file type */
+				if (!(ent->fts_statp->st_mode & S_IFMT) && lstat(ent->fts_accpath, ent->fts_statp))
+				{
+					error(ERROR_system(0), "%s: not found", ent->fts_path);
+					break;
+				}
+				if (S_ISLNK(ent->fts_statp->st_mode))
+					break;
+				/* FALLTHROUGH */
 			case FTS_F:
 				if (sp = openfile(ent->fts_accpath, "rb"))
 				{
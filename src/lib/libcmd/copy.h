@@ -0,0 +1,29 @@
+/***********************************************************************
+*                                                                      *
+*               This software is part of the ast package               *
+*            Copyright (c) 2026 Contributors to ksh 93u+m              *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*                                                                      *
+***********************************************************************/
+
+/*
+ * cat and tee common definitions
+ */
+
+#ifndef _COPY_H
+#define _COPY_H
+
+#define SPLICE_CHUNK	(1024*1024*1024)	/* per call; file offsets must not overflow */
+
+#define splice_move	_cmd_splicemove
+
+extern ssize_t		splice_move(int, int, ssize_t, Shbltin_t*);
+
+#endif
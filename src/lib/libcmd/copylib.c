@@ -0,0 +1,43 @@
+/***********************************************************************
+*                                                                      *
+*               This software is part of the ast package               *
+*            Copyright (c) 2026 Contributors to ksh 93u+m              *
+*                      and is licensed under the                       *
+*                 Eclipse Public License, Version 2.0                  *
+*                                                                      *
+*                A copy of the License is available at                 *
+*      https://www.eclipse.org/org/documents/epl-2.0/EPL-2.0.html      *
+*         (with md5 checksum 84283fa8859daf213bdda5a9f8d1be1d)         *
+*                                                                      *
+*                  Martijn Dekker <martijn@inlv.org>                   *
+*                                                                      *
+***********************************************************************/
+/*
+ * common support for cat and tee
+ */
+
+#include	<cmd.h>
+#include	<fcntl.h>
+#include	<copy.h>
+
+#include	"FEATURE/copy"
+
+/*
+ * splice(2) <n> bytes from the pipe <ifd> to <ofd>
+ * returns the number of bytes moved, which is less than <n> on error
+ */
+ssize_t splice_move(int ifd, int ofd, ssize_t n, Shbltin_t *context)
+{
+	ssize_t	done = 0;
+#if _lib_splice
+	ssize_t	m;
+	while(done < n)
+		if((m = splice(ifd,NULL,ofd,NULL,n-done,SPLICE_F_MOVE)) > 0)
+			done += m;
+		else if(!m || errno!=EINTR || sh_checksig(context))
+			break;
+#else
+	errno = ENOSYS;
+#endif
+	return done;
+}
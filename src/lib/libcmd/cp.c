@@ -135,6 +135,16 @@ static const char usage_tail[] =
 #include <stk.h>
 #include <tmx.h>
 
+#include "FEATURE/copy"
+
+#if _lib_sendfile
+#include <sys/sendfile.h>
+#endif
+#if _mac_FICLONE
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
 #define PATH_CHUNK	256
 
 #define CP		1
@@ -222,6 +232,38 @@ preserve(State_t* state, const char* path, struct stat* ns, struct stat* os)
 	}
 }
 
+/*
+ * copy the data of <rfd> to <wfd> without reading it into user space:
+ * share the data blocks on file systems that can clone files, otherwise
+ * let the kernel copy up to <size> bytes, advancing both file offsets
+ * 1 is returned if the whole file was cloned; if not, the caller copies
+ * whatever is left, which also reports any error
+ */
+
+static int
+kcopy(int rfd, int wfd, Sfoff_t size)
+{
+#if _lib_copy_file_range || _lib_sendfile
+	ssize_t	n = -1;
+#endif
+
+#if _mac_FICLONE
+	if (!ioctl(wfd, FICLONE, rfd))
+		return 1;
+#endif
+#if _lib_copy_file_range
+	while (size > 0 && (n = copy_file_range(rfd, NULL, wfd, NULL, size, 0)) > 0)
+		size -= n;
+	if (n >= 0)
+		return 0;
+#endif
+#if _lib_sendfile
+	while (size > 0 && (n = sendfile(wfd, rfd, NULL, size)) > 0)
+		size -= n;
+#endif
+	return 0;
+}
+
 /*
  * visit a single file and state.op to the destination
  */
@@ -587,6 +629,15 @@ visit(State_t* state, FTSENT* ent)
 					close(rfd);
 				return 0;
 			}
+			else if (ent->fts_statp->st_size > 0 && kcopy(rfd, wfd, ent->fts_statp->st_size))
+			{
+				close(rfd);
+				if (state->sync && fsync(wfd) || close(wfd))
+				{
+					error(ERROR_SYSTEM|2, "%s: %s %s error", ent->fts_path, state->path, ERROR_translate(0, 0, 0, "write"));
+					return 0;
+				}
+			}
 			else if (ent->fts_statp->st_size > 0)
 			{
 				if (!(ip = sfnew(NULL, NULL, SFIO_UNBOUND, rfd, SFIO_READ)))
@@ -326,6 +326,7 @@ b_rm(int argc, char** argv, Shbltin_t* context)
 	State_t		state;
 	FTS*		fts;
 	FTSENT*		ent;
+	int		flags;
 
 	cmdinit(argc, argv, context, ERROR_CATALOG, ERROR_NOTIFY);
 	memset(&state, 0, sizeof(state));
@@ -392,7 +393,14 @@ b_rm(int argc, char** argv, Shbltin_t* context)
 		state.verbose = 0;
 	state.uid = geteuid();
 	state.unconditional = state.unconditional && state.recursive && state.force;
-	if (fts = fts_open(argv, FTS_PHYSICAL, NULL))
+	/*
+	 * files below the operands need not be stat()ed
+	 * unless a protection prompt or --clobber needs their status
+	 */
+	flags = FTS_PHYSICAL;
+	if (state.recursive && (state.force || !state.terminal) && !state.clobber)
+		flags |= FTS_NOSTAT;
+	if (fts = fts_open(argv, flags, NULL))
 	{
 		while (!sh_checksig(context) && (ent = fts_read(fts)) && !rm(&state, ent));
 		fts_close(fts);
@@ -52,6 +52,9 @@ static const char usage[] =
 #include <cmd.h>
 #include <ls.h>
 #include <sig.h>
+#include <copy.h>
+
+#include "FEATURE/copy"
 
 typedef struct Tee_s
 {
@@ -87,6 +90,193 @@ tee_write(Sfio_t* fp, const void* buf, size_t n, Sfdisc_t* handle)
 	return n;
 }
 
+#if _lib_splice && _lib_tee
+
+/*
+ * write <n> bytes from <buf> to <fd>
+ */
+
+static int
+tee_writen(int fd, const char* buf, ssize_t n, Shbltin_t* context)
+{
+	ssize_t		m;
+
+	while (n > 0)
+		if ((m = write(fd, buf, n)) > 0)
+		{
+			buf += m;
+			n -= m;
+		}
+		else if (!m || errno != EINTR || sh_checksig(context))
+			return -1;
+	return 0;
+}
+
+/*
+ * read the <n> bytes in the pipe <ifd> and write them to <ofd> and, unless it is -1, to <fd>
+ */
+
+static int
+tee_drain(int ifd, int ofd, int fd, ssize_t n, Shbltin_t* context)
+{
+	char		buf[SFIO_BUFSIZE];
+	ssize_t		m;
+
+	while (n > 0)
+		if ((m = read(ifd, buf, n < sizeof(buf) ? n : sizeof(buf))) > 0)
+		{
+			if (tee_writen(ofd, buf, m, context) || fd >= 0 && tee_writen(fd, buf, m, context))
+				return -1;
+			n -= m;
+		}
+		else if (!m || errno != EINTR || sh_checksig(context))
+			return -1;
+	return 0;
+}
+
+#endif
+
+/*
+ * copy the standard input to the standard output and to at most one file
+ * with tee(2) and splice(2), which do not copy the data through user space;
+ * the file must not be in append mode
+ * both ends of tee(2) must be pipes, so private pipes stand in for standard
+ * input and output if these are sockets, as they are in ksh pipelines
+ * neither call waits for input; an sfio read does that instead, so that the
+ * shell's read discipline can act on a signal that arrived meanwhile
+ * -1 is returned on error, 0 at end of file, and 1 if the caller must copy
+ * the rest because this cannot be used
+ */
+
+static int
+tee_splice(Tee_t* tp, int oflag, Shbltin_t* context)
+{
+#if _lib_splice && _lib_tee
+	struct stat	st;
+	ssize_t		n;
+	ssize_t		m;
+	ssize_t		k;
+	char*		buf;
+	int		ifd = sffileno(sfstdin);
+	int		ofd = sffileno(sfstdout);
+	int		fd = tp ? tp->fd[0] : -1;
+	int		in[2] = { -1, -1 };
+	int		out[2] = { -1, -1 };
+	int		src;
+	int		moved = 0;
+	int		nonblock;
+	int		r;
+
+	if (tp && (tp->fd[1] >= 0 || (oflag & O_APPEND)))
+		return 1;
+	if (fstat(ofd, &st) || !S_ISFIFO(st.st_mode) && !S_ISSOCK(st.st_mode))
+		return 1;
+	r = fd >= 0 && !S_ISFIFO(st.st_mode);
+	if (fstat(ifd, &st) || !S_ISFIFO(st.st_mode) && !S_ISSOCK(st.st_mode))
+		return 1;
+	if (sfreserve(sfstdin, 0, -1) || sfsync(sfstdout))
+		return 1;
+	if (r && pipe(out))
+		return 1;
+	if (!S_ISFIFO(st.st_mode) && pipe(in))
+	{
+		if (out[0] >= 0)
+		{
+			close(out[0]);
+			close(out[1]);
+		}
+		return 1;
+	}
+	src = in[0] >= 0 ? in[0] : ifd;
+	nonblock = in[0] < 0 ? SPLICE_F_NONBLOCK : 0;
+	for (;;)
+	{
+		if (in[1] < 0)
+			n = SPLICE_CHUNK;
+		else if ((n = splice(ifd, NULL, in[1], NULL, SPLICE_CHUNK, SPLICE_F_MOVE|SPLICE_F_NONBLOCK)) <= 0)
+			goto fail;
+		while (n > 0)
+		{
+			if (fd < 0)
+				m = splice(src, NULL, ofd, NULL, n, SPLICE_F_MOVE|nonblock);
+			else
+				m = tee(src, out[1] >= 0 ? out[1] : ofd, n, nonblock);
+			if (m < 0 && errno == EINTR && !sh_checksig(context))
+				continue;
+			if (m <= 0)
+			{
+				n = m;
+				goto fail;
+			}
+			if (fd >= 0 && out[0] >= 0 && splice_move(out[0], ofd, m, context) != m)
+			{
+				r = -1;
+				goto done;
+			}
+			/* tee(2) leaves the data in the input pipe for the file */
+			if (fd >= 0 && (k = splice_move(src, fd, m, context)) != m)
+			{
+				/*
+				 * if this is the first chunk, the file may not support splice(2):
+				 * write what is left in the pipes and let the caller copy the rest
+				 */
+				if (moved || errno == EINTR || tee_drain(src, fd, -1, m - k, context) || in[0] >= 0 && tee_drain(in[0], ofd, fd, n - m, context))
+					r = -1;
+				else
+					r = 1;
+				goto done;
+			}
+			moved = 1;
+			if (in[0] < 0)
+				break;
+			n -= m;
+		}
+		continue;
+ fail:
+		if (!n)
+		{
+			r = 0;
+			break;
+		}
+		if (errno == EAGAIN)
+		{
+			if (!(buf = sfreserve(sfstdin, SFIO_UNBOUND, 0)))
+			{
+				r = sfeof(sfstdin) && !sferror(sfstdin) ? 0 : -1;
+				break;
+			}
+			n = sfvalue(sfstdin);
+			if (sfwrite(sfstdout, buf, n) != n || sfsync(sfstdout))
+			{
+				r = -1;
+				break;
+			}
+			moved = 1;
+			continue;
+		}
+		if (errno != EINTR || sh_checksig(context))
+		{
+			r = moved || errno != EINVAL && errno != ENOSYS ? -1 : 1;
+			break;
+		}
+	}
+ done:
+	if (in[0] >= 0)
+	{
+		close(in[0]);
+		close(in[1]);
+	}
+	if (out[0] >= 0)
+	{
+		close(out[0]);
+		close(out[1]);
+	}
+	return r;
+#else
+	return 1;
+#endif
+}
+
 static void
 tee_cleanup(Tee_t* tp)
 {
@@ -111,6 +301,7 @@ b_tee(int argc, char** argv, Shbltin_t* context)
 	int*		hp;
 	char*		cp;
 	int		line;
+	int		n;
 
 	if (argc <= 0)
 	{
@@ -198,8 +389,17 @@ b_tee(int argc, char** argv, Shbltin_t* context)
 			UNREACHABLE();
 		}
 	}
-	if ((sfmove(sfstdin, sfstdout, SFIO_UNBOUND, -1) < 0 || !sfeof(sfstdin)) && !ERROR_PIPE(errno) && errno != EINTR)
-		error(ERROR_system(0), "read error");
+	if ((n = tee_splice(tp, oflag, context)) > 0)
+	{
+		if ((sfmove(sfstdin, sfstdout, SFIO_UNBOUND, -1) < 0 || !sfeof(sfstdin)) && !ERROR_PIPE(errno) && errno != EINTR)
+			error(ERROR_system(0), "read error");
+	}
+	else if (n < 0 && (tp || !ERROR_PIPE(errno)) && errno != EINTR)
+	{
+		/* as with the sfio copy, a broken pipe is an error only if there are files */
+		error(ERROR_system(0), "write error");
+		sfpurge(sfstdout);
+	}
 	if (sfsync(sfstdout))
 		error(ERROR_system(0), "write error");
 	tee_cleanup(tp);
@@ -151,6 +151,94 @@ static int chkstate(int state, unsigned int c)
 	return state;
 }
 
+/*
+ * count eight bytes at a time; WC_ZERO() flags the high bit of each zero byte
+ * and WC_PREV() shifts the flag of each byte onto the byte after it
+ */
+
+#define WC_ONES		((uint64_t)0x0101010101010101)
+#define WC_HIGH		(WC_ONES<<7)
+#define WC_EVEN		((uint64_t)0x00ff00ff00ff00ff)
+#define WC_ZERO(x)	(~((((x)&~WC_HIGH)+~WC_HIGH)|(x))&WC_HIGH)
+#define WC_SUM(a)	(((((a)&WC_EVEN)+(((a)>>8)&WC_EVEN))*((uint64_t)0x0001000100010001))>>48)
+#if _ast_intswap
+#define WC_PREV(s,p)	(((s)<<8)|((p)>>56))
+#else
+#define WC_PREV(s,p)	(((s)>>8)|((p)<<56))
+#endif
+
+/*
+ * add the newlines and, if <words> is set, the word starts in the <n> bytes
+ * at <cp> to <*nlines> and <*nwords>; <*lastp> is the type of the byte before
+ * <cp> and is set to the type of the last byte counted
+ * the ASCII spaces must be the white space in the type table
+ * if <ascii> is set, stop at the first non-ASCII byte
+ * the number of bytes counted is returned
+ */
+
+static size_t wc_scan(Wc_t *wp, const unsigned char *cp, size_t n, int words, int ascii, int *lastp, Sfoff_t *nlines, Sfoff_t *nwords)
+{
+	const unsigned char*	bp = cp;
+	char*			type = wp->type;
+	uint64_t		w;
+	uint64_t		s = 0;
+	uint64_t		p;
+	uint64_t		nl;
+	uint64_t		sl;
+	uint64_t		sw;
+	unsigned char		f[8];
+	int			c;
+	int			i;
+	int			k;
+
+	p = spc(*lastp) ? WC_HIGH : 0;
+	while (n >= 8)
+	{
+		sl = sw = 0;
+		for (k = 0; k < 255 && n >= 8; k++, n -= 8, cp += 8)
+		{
+			memcpy(&w, cp, 8);
+			if ((ascii || words) && (w & WC_HIGH))
+			{
+				if (ascii)
+					break;
+				for (i = 0; i < 8; i++)
+					f[i] = spc(type[cp[i]]) ? 0x80 : 0;
+				memcpy(&s, f, 8);
+			}
+			else if (words)
+			{
+				/* ' ' or '\t' through '\r' */
+				s = w ^ (WC_ONES * ' ');
+				s = WC_ZERO(s) | (((w|WC_HIGH) - WC_ONES * '\t') & ((WC_ONES * '\r'|WC_HIGH) - w) & WC_HIGH);
+			}
+			nl = w ^ (WC_ONES * '\n');
+			sl += WC_ZERO(nl) >> 7;
+			if (words)
+			{
+				sw += (~s & WC_PREV(s, p) & WC_HIGH) >> 7;
+				p = s;
+			}
+		}
+		*nlines += WC_SUM(sl);
+		*nwords += WC_SUM(sw);
+		if (k < 255 && n >= 8)
+			break;
+	}
+	c = cp > bp ? type[cp[-1]] : *lastp;
+	for (; n > 0; n--, cp++)
+	{
+		if (ascii && *cp >= 0x80)
+			break;
+		if (words && !spc(type[*cp]) && spc(c))
+			(*nwords)++;
+		if (eol(c = type[*cp]))
+			(*nlines)++;
+	}
+	*lastp = c;
+	return cp - bp;
+}
+
 /*
  * compute the line, word, and character count for file <fd>
  */
@@ -174,10 +262,16 @@ int wc_count(Wc_t *wp, Sfio_t *fd, const char* file)
 	unsigned char*	buff;
 	wchar_t		x;
 	unsigned char	side[32];
+	int		words = (wp->mode & WC_WORDS) != 0;
+	int		fast = !(wp->mode & WC_LONGEST);
 
 	sfset(fd,SFIO_WRITE,1);
 	nlines = nwords = nchars = nbytes = 0;
 	wp->longest = 0;
+	/* wc_scan() knows only the ASCII white space */
+	for (n = 0; words && fast && n < 0x80; n++)
+		if (!spc(type[n]) != !(n == ' ' || n >= '\t' && n <= '\r'))
+			fast = 0;
 	if (wp->mb < 0 && (wp->mode & (WC_MBYTE|WC_WORDS)))
 	{
 		cp = buff = endbuff = 0;
@@ -255,18 +349,16 @@ int wc_count(Wc_t *wp, Sfio_t *fd, const char* file)
 			while ((cp = (unsigned char*)sfreserve(fd, SFIO_UNBOUND, 0)) && (c = sfvalue(fd)) > 0)
 			{
 				nchars += c;
-				endbuff = cp + c;
-				if (*--endbuff == '\n')
-					nlines++;
-				else
-					*endbuff = '\n';
-				for (;;)
-					if (*cp++ == '\n')
-					{
-						if (cp > endbuff)
-							break;
-						nlines++;
-					}
+				wc_scan(wp, cp, c, 0, 0, &lasttype, &nlines, &nwords);
+			}
+		}
+		else if (fast)
+		{
+			/* wc_scan() counts word starts and all newlines */
+			while ((cp = (unsigned char*)sfreserve(fd, SFIO_UNBOUND, 0)) && (c = sfvalue(fd)) > 0)
+			{
+				nchars += c;
+				wc_scan(wp, cp, c, words, 0, &lasttype, &nlines, &nwords);
 			}
 		}
 		else
@@ -358,6 +450,17 @@ int wc_count(Wc_t *wp, Sfio_t *fd, const char* file)
 				endbuff = start;
 				continue;
 			}
+			if(fast && c > 2 && !skip && !state && wasspace && !mbc(lasttype))
+			{
+				/* count up to the first multibyte character; wc_scan() counts the word and newline the loop below defers */
+				nwords += !lasttype;
+				nlines += eol(lasttype) != 0;
+				n = wc_scan(wp, cp, c-2, words, 1, &lasttype, &nlines, &nwords);
+				nwords -= !lasttype;
+				nlines -= eol(lasttype) != 0;
+				cp = buff += n;
+				c -= n;
+			}
 			lastchar = cp[--c];
 			endbuff = cp+c;
 			cp[c] = '\n';
@@ -47,14 +47,13 @@ typedef struct Crc_s
 	Crcnum_t		init;
 	Crcnum_t		done;
 	Crcnum_t		xorsize;
-	const Crcnum_t		*tab; /* use |const| to give the compiler a hint that the data won't change */
-	Crcnum_t		tabdata[256];
+	Crcnum_t		tab[8][256];	/* tab[k][i]: crc of byte i followed by k zero bytes */
 	unsigned int		addsize;
 	unsigned int		rotate;
 } Crc_t;
 
-#define CRC(p,s,c)		(s = (s >> 8) ^ (p)->tab[(s ^ (c)) & 0xff])
-#define CRCROTATE(p,s,c)	(s = (s << 8) ^ (p)->tab[((s >> 24) ^ (c)) & 0xff])
+#define CRC(p,s,c)		(s = (s >> 8) ^ (p)->tab[0][(s ^ (c)) & 0xff])
+#define CRCROTATE(p,s,c)	(s = (s << 8) ^ (p)->tab[0][((s >> 24) ^ (c)) & 0xff])
 
 static const
 Crcnum_t posix_cksum_tab[256] = {
@@ -139,7 +138,7 @@ crc_open(const Method_t* method, const char* name)
 		sum->rotate=1;
 
 		/* Optimized codepath for POSIX cksum to save startup time */
-		sum->tab=posix_cksum_tab;
+		memcpy(sum->tab[0], posix_cksum_tab, sizeof(sum->tab[0]));
 	}
 	else
 	{
@@ -176,7 +175,7 @@ crc_open(const Method_t* method, const char* name)
 		p[0] = polynomial;
 		for (i = 1; i < 8; i++)
 			p[i] = (p[i-1] << 1) ^ ((p[i-1] & 0x80000000) ? polynomial : 0);
-		for (i = 0; i < elementsof(sum->tabdata); i++)
+		for (i = 0; i < elementsof(sum->tab[0]); i++)
 		{
 			t = 0;
 			x = i;
@@ -186,23 +185,28 @@ crc_open(const Method_t* method, const char* name)
 					t ^= p[j];
 				x >>= 1;
 			}
-			sum->tabdata[i] = t;
+			sum->tab[0][i] = t;
 		}
 	}
 	else
 	{
-		for (i = 0; i < elementsof(sum->tabdata); i++)
+		for (i = 0; i < elementsof(sum->tab[0]); i++)
 		{
 			x = i;
 			for (j = 0; j < 8; j++)
 				x = (x>>1) ^ ((x & 1) ? polynomial : 0);
-			sum->tabdata[i] = x;
+			sum->tab[0][i] = x;
 		}
-
-		sum->tab=sum->tabdata;
 	}
 	}
 
+	/* the tables for crc_block() to do eight bytes at a time */
+	for (j = 1; j < elementsof(sum->tab); j++)
+		for (i = 0; i < elementsof(sum->tab[0]); i++)
+		{
+			x = sum->tab[j-1][i];
+			sum->tab[j][i] = sum->rotate ? (x << 8) ^ sum->tab[0][x >> 24] : (x >> 8) ^ sum->tab[0][x & 0xff];
+		}
 	return (Sum_t*)sum;
 }
 
@@ -215,97 +219,48 @@ crc_init(Sum_t* p)
 	return 0;
 }
 
-#if !(defined(__clang__) && (__clang_major__ < 3 || (__clang_major__ == 3 && __clang_minor__ < 6))) && \
-	(defined(__SUNPRO_C) || (defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ > 0))))
-
-#if defined(__SUNPRO_C)
-#    include <sun_prefetch.h>
-#    define sum_prefetch(addr) sun_prefetch_read_many((void *)(addr))
-#elif defined(__GNUC__)
-#    define sum_prefetch(addr) __builtin_prefetch((addr), 0, 3)
-#endif
-
-#define CBLOCK_SIZE (64)
-#if !__clang__ && !__GNUC__
-#pragma unroll(16)
-#endif
+/*
+ * the crc of eight bytes is the xor of the crcs of each byte shifted by
+ * the bytes that follow it, looked up in tab[7] through tab[0]
+ */
 
 static int
 crc_block(Sum_t* p, const void* s, size_t n)
 {
 	Crc_t*			sum = (Crc_t*)p;
-	Crcnum_t	c = sum->sum;
+	Crcnum_t		c = sum->sum;
+	Crcnum_t		x;
+	Crcnum_t		y;
 	const unsigned char*	b = (const unsigned char*)s;
 	const unsigned char*	e = b + n;
-	unsigned short i;
-
-	sum_prefetch(b);
 
 	if (sum->rotate)
 	{
-		while (n > CBLOCK_SIZE)
+		for (; e - b >= 8; b += 8)
 		{
-			sum_prefetch(b+CBLOCK_SIZE);
-#if defined(__clang__)
-			#pragma clang loop unroll_count(16)
-#endif
-			for(i=0 ; i < CBLOCK_SIZE ; i++)
-			{
-				CRCROTATE(sum, c, *b++);
-			}
-
-			n-=CBLOCK_SIZE;
+			x = c ^ ((Crcnum_t)b[0] << 24 | (Crcnum_t)b[1] << 16 | (Crcnum_t)b[2] << 8 | b[3]);
+			y = (Crcnum_t)b[4] << 24 | (Crcnum_t)b[5] << 16 | (Crcnum_t)b[6] << 8 | b[7];
+			c = sum->tab[7][x >> 24] ^ sum->tab[6][(x >> 16) & 0xff] ^ sum->tab[5][(x >> 8) & 0xff] ^ sum->tab[4][x & 0xff]
+			  ^ sum->tab[3][y >> 24] ^ sum->tab[2][(y >> 16) & 0xff] ^ sum->tab[1][(y >> 8) & 0xff] ^ sum->tab[0][y & 0xff];
 		}
-
 		while (b < e)
-		{
 			CRCROTATE(sum, c, *b++);
-		}
 	}
 	else
 	{
-		while (n > CBLOCK_SIZE)
+		for (; e - b >= 8; b += 8)
 		{
-			sum_prefetch(b+CBLOCK_SIZE);
-#if defined(__clang__)
-			#pragma clang loop unroll_count(16)
-#endif
-			for(i=0 ; i < CBLOCK_SIZE ; i++)
-			{
-				CRC(sum, c, *b++);
-			}
-
-			n-=CBLOCK_SIZE;
+			x = c ^ (b[0] | (Crcnum_t)b[1] << 8 | (Crcnum_t)b[2] << 16 | (Crcnum_t)b[3] << 24);
+			y = b[4] | (Crcnum_t)b[5] << 8 | (Crcnum_t)b[6] << 16 | (Crcnum_t)b[7] << 24;
+			c = sum->tab[7][x & 0xff] ^ sum->tab[6][(x >> 8) & 0xff] ^ sum->tab[5][(x >> 16) & 0xff] ^ sum->tab[4][x >> 24]
+			  ^ sum->tab[3][y & 0xff] ^ sum->tab[2][(y >> 8) & 0xff] ^ sum->tab[1][(y >> 16) & 0xff] ^ sum->tab[0][y >> 24];
 		}
-
 		while (b < e)
-		{
 			CRC(sum, c, *b++);
-		}
 	}
-
-	sum->sum = c;
-	return 0;
-}
-#else
-static int
-crc_block(Sum_t* p, const void* s, size_t n)
-{
-	Crc_t*			sum = (Crc_t*)p;
-	Crcnum_t	c = sum->sum;
-	unsigned char*	b = (unsigned char*)s;
-	unsigned char*	e = b + n;
-
-	if (sum->rotate)
-		while (b < e)
-			CRCROTATE(sum, c, *b++);
-	else
-		while (b < e)
-			CRC(sum, c, *b++);
 	sum->sum = c;
 	return 0;
 }
-#endif
 
 static int
 crc_done(Sum_t* p)
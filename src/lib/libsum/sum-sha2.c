@@ -55,6 +55,8 @@
  *
  */
 
+#define SHA2_UNROLL_TRANSFORM	1
+
 /*** SHA-256/384/512 Machine Architecture Definitions *****************/
 
 #ifndef __USE_BSD